@@ -1,6 +1,9 @@
 #include "plugin.hpp"
+#include "dsp/commands.hpp"
 #include "dsp/compander.hpp"
+#include "dsp/decimator.hpp"
 #include "dsp/functions.hpp"
+#include "dsp/governor.hpp"
 
 namespace musx {
 
@@ -60,8 +63,20 @@ struct Delay : Module {
 	float_4 out = 0;
 	float_4 lastOut = 0;
 
+	float sampleRate = 48000.f;
+	int internalSampleRate = 384000; // [Hz] of the BBD simulation
 	int oversamplingRate = 8;
 
+	// reduces the oversampling rate when the CPU budget is exceeded
+	musx::CpuGovernor governor;
+
+	// settings from the context menu, applied in process()
+	enum CommandId {
+		SET_INTERNAL_SAMPLE_RATE,
+		SET_OVERSAMPLE_SATURATION
+	};
+	musx::CommandQueue<> commands;
+
 	double phasor = 0;
 
 	static constexpr float minCutoff = 200.f; // Hz
@@ -79,6 +94,13 @@ struct Delay : Module {
 	// DC block
 	musx::TOnePole<float_4> dcBlocker;
 
+	// input saturation
+	musx::TanhADAA1 inSaturator;
+
+	// output saturation
+	bool oversampleSaturation = false;
+	Oversampler<float_4, 4> saturationOversampler;
+
 	dsp::ClockDivider lightDivider;
 	dsp::ClockDivider knobDivider;
 
@@ -116,8 +138,14 @@ struct Delay : Module {
 		configInput(L_INPUT, "Left / Mono");
 		configInput(R_INPUT, "Right");
 
-		configOutput(L_OUTPUT, "Left");
-		configOutput(R_OUTPUT, "Right");
+		for (int i = L_OUTPUT; i <= R_OUTPUT; i++)
+		{
+			CpuGovernorPortInfo* outInfo = configOutput<CpuGovernorPortInfo>(i, i == L_OUTPUT ? "Left" : "Right");
+			outInfo->governor = &governor;
+			outInfo->getSetting = [=]() {
+				return string::f("%dx oversampling", oversamplingRate);
+			};
+		}
 
 		lightDivider.setDivision(256);
 		knobDivider.setDivision(16);
@@ -132,12 +160,41 @@ struct Delay : Module {
 		dcBlocker.setCutoffFreq(20.f/e.sampleRate);
 		lightFilter.setCutoffFreq(5.f/e.sampleRate*lightDivider.getDivision());
 
-		int factor = std::round(std::log2(46050/e.sampleRate));
-		oversamplingRate = 8 * pow(2, factor);
-		oversamplingRate = std::fmax(1, oversamplingRate);
+		sampleRate = e.sampleRate;
+		setInternalSampleRate(internalSampleRate);
+	}
+
+	void setInternalSampleRate(int arg)
+	{
+		internalSampleRate = arg;
+		int rate = oversamplingRateFor(internalSampleRate, sampleRate, 64);
+		governor.maxLevel = std::log2(rate);
+		oversamplingRate = std::max(1, rate >> governor.level);
+	}
+
+	void applyCommand(const musx::Command& command)
+	{
+		switch (command.id)
+		{
+			case SET_INTERNAL_SAMPLE_RATE:
+				setInternalSampleRate(command.value);
+				break;
+			case SET_OVERSAMPLE_SATURATION:
+				saturationOversampler.reset();
+				oversampleSaturation = command.value;
+				break;
+		}
 	}
 
 	void process(const ProcessArgs& args) override {
+		governor.begin();
+
+		musx::Command command;
+		while (commands.pop(command))
+		{
+			applyCommand(command);
+		}
+
 		if (knobDivider.process())
 		{
 			int newDelayLineSize = std::pow(2, params[BBD_SIZE_PARAM].getValue());
@@ -205,8 +262,8 @@ struct Delay : Module {
 			inMono[1] = (params[FEEDBACK_PARAM].getValue() + 0.3f * inputs[FEEDBACK_CV_INPUT].getVoltageSum()) * lastOut[0];
 		}
 
-		// saturate
-		inMono = musx::tanh(inMono / 10.f) * 10.f; // +-10V
+		// saturate, anti-aliased
+		inMono = inSaturator.process(inMono / 10.f) * 10.f; // +-10V
 
 		// compressor
 		inMono = compander.compress(inMono);
@@ -269,9 +326,21 @@ struct Delay : Module {
 		out = compander.expand(out);
 
 		// saturate
-		out = musx::tanh(out / 10.f) * 10.f; // +-10V
+		float_4 saturated = musx::tanh(out / 10.f) * 10.f; // +-10V
 
-		lastOut = out;
+		// the feedback stays at the sample rate, the latency of the oversampler would change the delay time
+		lastOut = saturated;
+
+		if (oversampleSaturation)
+		{
+			out = saturationOversampler.process(out, [](float_4 x) {
+				return musx::tanh(x / 10.f) * 10.f;
+			});
+		}
+		else
+		{
+			out = saturated;
+		}
 
 		// L R
 		float outMono = 0.5f * (out[0] + out[1]);
@@ -320,6 +389,43 @@ struct Delay : Module {
 
 			lights[INVERT_LIGHT].setBrightness(params[INVERT_PARAM].getValue());
 		}
+
+		if (governor.end(args.sampleTime))
+		{
+			setInternalSampleRate(internalSampleRate);
+		}
+	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		json_object_set_new(rootJ, "internalSampleRate", json_integer(internalSampleRate));
+		json_object_set_new(rootJ, "oversampleSaturation", json_boolean(oversampleSaturation));
+		json_object_set_new(rootJ, "cpuGovernor", json_boolean(governor.enabled));
+		json_object_set_new(rootJ, "cpuGovernorBudget", json_real(governor.budget));
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		json_t* internalSampleRateJ = json_object_get(rootJ, "internalSampleRate");
+		if (internalSampleRateJ)
+		{
+			setInternalSampleRate(json_integer_value(internalSampleRateJ));
+		}
+		json_t* oversampleSaturationJ = json_object_get(rootJ, "oversampleSaturation");
+		if (oversampleSaturationJ)
+		{
+			oversampleSaturation = json_boolean_value(oversampleSaturationJ);
+		}
+		json_t* cpuGovernorJ = json_object_get(rootJ, "cpuGovernor");
+		if (cpuGovernorJ)
+		{
+			governor.setEnabled(json_boolean_value(cpuGovernorJ));
+		}
+		json_t* cpuGovernorBudgetJ = json_object_get(rootJ, "cpuGovernorBudget");
+		if (cpuGovernorBudgetJ)
+		{
+			governor.setBudget(json_real_value(cpuGovernorBudgetJ));
+		}
 	}
 };
 
@@ -362,6 +468,34 @@ struct DelayWidget : ModuleWidget {
 		addOutput(createOutputCentered<ThemedPJ301MPort>(mm2px(Vec(38.312, 112.438)), module, Delay::L_OUTPUT));
 		addOutput(createOutputCentered<ThemedPJ301MPort>(mm2px(Vec(53.552, 112.438)), module, Delay::R_OUTPUT));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		Delay* module = getModule<Delay>();
+
+		menu->addChild(new MenuSeparator);
+
+		menu->addChild(createIndexSubmenuItem("Internal sample rate", {"96 kHz", "192 kHz", "384 kHz", "768 kHz"},
+			[=]() {
+				return std::log2(module->internalSampleRate / 96000);
+			},
+			[=](int mode) {
+				module->commands.push(Delay::SET_INTERNAL_SAMPLE_RATE, 96000 * std::pow(2, mode));
+			}
+		));
+
+		menu->addChild(createBoolMenuItem("Oversampled output saturation", "",
+			[=]() {
+				return module->oversampleSaturation;
+			},
+			[=](int mode) {
+				module->commands.push(Delay::SET_OVERSAMPLE_SATURATION, mode);
+			}
+		));
+
+		menu->addChild(new MenuSeparator);
+
+		appendCpuGovernorMenu(menu, &module->governor);
+	}
 };
 
 
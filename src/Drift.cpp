@@ -1,11 +1,18 @@
 #include "plugin.hpp"
-#include "dsp/filters.hpp"
+#include "dsp/noise.hpp"
 
 namespace musx {
 
 using namespace rack;
 using simd::float_4;
 
+/**
+ * Drift of 16 channels, sent from the first Drift module of a bus to the following ones
+ */
+struct DriftBusMessage {
+	float_4 drift[4] = {0};
+};
+
 struct Drift : Module {
 	enum ParamId {
 		CONST_PARAM,
@@ -29,17 +36,49 @@ struct Drift : Module {
 	const float minFreq = 0.01f; // min freq [Hz]
 	const float base = 1000.f/minFreq; // max freq/min freq
 	const int clockDivider = 16;
+	const float driftVoltage = 2.f; // rms drift voltage [V]
 
 	int channels = 1;
 
 	float_4 diverge[4];
 
-	musx::TOnePole<float_4> lowpass[4];
+	enum DriftSpectrum {
+		BROWN,
+		PINK
+	};
+	int driftSpectrum = BROWN;
+
+	/**
+	 * noise generators of 16 channels of drift
+	 */
+	struct DriftBank {
+		musx::BrownNoise16 brownNoise;
+		musx::PinkNoise16<> pinkNoise;
+
+		// pink noise is clocked at twice the drift rate, and interpolated
+		float_4 pinkPrev[4] = {0};
+		float_4 pinkNext[4] = {0};
+	};
+
+	// bus mode: the first Drift module generates the drift for up to maxBusLength adjacent Drift modules
+	static const int maxBusLength = 16;
+	bool busMode = false;
+	DriftBusMessage busMessages[2];
+
+	DriftBank ownBank;
+
+	// banks of the following modules, only allocated when the module is the first one of a bus, see allocateBusBanks()
+	std::atomic<DriftBank*> busBanks {nullptr};
+	DriftBank* prevBusBanks = nullptr;
+
+	float pinkPhase = 0.f;
+	float pinkPhaseInc = 0.f;
+
+	float_4 ownDrift[4] = {0};
 
 	dsp::ClockDivider divider;
 
 	float lastRateParam = -1.f;
-	float driftScale = 1.f;
 
 	float prevRandomizeValue = 0.f;
 
@@ -55,9 +94,92 @@ struct Drift : Module {
 
 		divider.setDivision(clockDivider);
 
+		leftExpander.producerMessage = &busMessages[0];
+		leftExpander.consumerMessage = &busMessages[1];
+
 		randomizeDiverge();
 	}
 
+	~Drift() {
+		delete[] busBanks.load();
+	}
+
+	static bool isBusModule(Module* module)
+	{
+		return module && module->model == modelDrift && static_cast<Drift*>(module)->busMode;
+	}
+
+	/**
+	 * number of adjacent bus modules to the left, counted up to maxBusLength
+	 */
+	int busPosition()
+	{
+		int position = 0;
+		Module* module = leftExpander.module;
+		while (position < maxBusLength && isBusModule(module))
+		{
+			++position;
+			module = module->leftExpander.module;
+		}
+		return position;
+	}
+
+	/**
+	 * the first module of a bus allocates the banks of the following modules.
+	 * Called when the neighbours or the bus mode change, not from process(). The banks are kept until the module is deleted.
+	 */
+	void allocateBusBanks()
+	{
+		if (busMode && !isBusModule(leftExpander.module) && isBusModule(rightExpander.module) && !busBanks.load())
+		{
+			busBanks.store(new DriftBank[maxBusLength - 1]);
+		}
+	}
+
+	/**
+	 * after a change of the bus mode, the first module of the bus may need the banks
+	 */
+	void allocateBusLeaderBanks()
+	{
+		Drift* leader = this;
+		for (int k = 0; k < maxBusLength && isBusModule(leader->leftExpander.module); ++k)
+		{
+			leader = static_cast<Drift*>(leader->leftExpander.module);
+		}
+		leader->allocateBusBanks();
+	}
+
+	void onExpanderChange(const ExpanderChangeEvent& e) override {
+		allocateBusBanks();
+	}
+
+	/**
+	 * calculate the drift of a bank
+	 */
+	void generateDrift(DriftBank& bank, bool pinkTick, float_4* out)
+	{
+		if (driftSpectrum == PINK)
+		{
+			if (pinkTick)
+			{
+				for (int g = 0; g < 4; ++g)
+				{
+					bank.pinkPrev[g] = bank.pinkNext[g];
+				}
+				bank.pinkNoise.process(bank.pinkNext);
+			}
+
+			for (int g = 0; g < 4; ++g)
+			{
+				out[g] = bank.pinkPrev[g] + pinkPhase * (bank.pinkNext[g] - bank.pinkPrev[g]);
+			}
+		}
+		else
+		{
+			bank.brownNoise.process(out);
+		}
+	}
+
 	void randomizeDiverge()
 	{
 		for (int c = 0; c < 4; c += 1) {
@@ -83,33 +205,60 @@ struct Drift : Module {
 			}
 			prevRandomizeValue = params[RANDOMIZE_PARAM].getValue();
 
-			// update filter frequency
-			if (params[RATE_PARAM].getValue() != lastRateParam)
+			// update drift rate, also for newly allocated bus banks
+			DriftBank* banks = busBanks.load(std::memory_order_acquire);
+			if (params[RATE_PARAM].getValue() != lastRateParam || banks != prevBusBanks)
 			{
-				for (int c = 0; c < 16; c += 4) {
-					float cutoffFreq = simd::pow(base, params[RATE_PARAM].getValue()) * minFreq / args.sampleRate * clockDivider;
+				float driftFreq = std::pow(base, params[RATE_PARAM].getValue()) * minFreq / args.sampleRate * clockDivider; // f / f_s
 
-					driftScale = std::exp(-1.2f * std::log10(cutoffFreq*48000 / divider.getDivision())) * 128.f + 7.f;
+				ownBank.brownNoise.setCutoffFreq(driftFreq);
+				for (int i = 0; banks && i < maxBusLength - 1; ++i)
+				{
+					banks[i].brownNoise.setCutoffFreq(driftFreq);
+				}
+				prevBusBanks = banks;
+				pinkPhaseInc = std::fmin(2.f * driftFreq, 1.f);
 
-					lowpass[c/4].setCutoffFreq(cutoffFreq);
-					lowpass[c/4].tmp = simd::clamp(lowpass[c/4].tmp, -5.f/driftScale, 5.f/driftScale);
+				lastRateParam = params[RATE_PARAM].getValue();
+			}
 
-					lastRateParam = params[RATE_PARAM].getValue();
-				}
+			// all 16 channels at once
+			// modules beyond maxBusLength are not reached by the first module of the bus, and generate their own drift
+			const float_4* drift = ownDrift;
+			int position = busMode ? busPosition() : 0;
+			if (position > 0 && position < maxBusLength)
+			{
+				// drift is generated by the first module of the bus
+				drift = static_cast<DriftBusMessage*>(leftExpander.consumerMessage)->drift;
 			}
+			else
+			{
+				pinkPhase += pinkPhaseInc;
+				bool pinkTick = pinkPhase >= 1.f;
+				if (pinkTick)
+				{
+					pinkPhase -= 1.f;
+				}
 
-			for (int c = 0; c < channels; c += 4) {
-				float_4 rn = {rack::random::get<float>() - 0.5f,
-						   	  rack::random::get<float>() - 0.5f,
-							  rack::random::get<float>() - 0.5f,
-							  rack::random::get<float>() - 0.5f};
+				generateDrift(ownBank, pinkTick, ownDrift);
 
-				lowpass[c/4].process(rn);
-				float_4 drift = lowpass[c/4].lowpass();
+				if (busMode && position == 0 && banks)
+				{
+					// generate drift for the following modules, directly into their message buffers
+					Module* module = rightExpander.module;
+					for (int i = 1; i < maxBusLength && isBusModule(module); ++i)
+					{
+						generateDrift(banks[i - 1], pinkTick, static_cast<DriftBusMessage*>(module->leftExpander.producerMessage)->drift);
+						module->leftExpander.requestMessageFlip();
+						module = module->rightExpander.module;
+					}
+				}
+			}
 
+			for (int c = 0; c < channels; c += 4) {
 				outputs[OUT_OUTPUT].setVoltageSimd(simd::clamp(
 						params[CONST_PARAM].getValue() * params[CONST_PARAM].getValue() * diverge[c/4] +
-						params[DRIFT_PARAM].getValue() * params[DRIFT_PARAM].getValue() * driftScale * drift,
+						params[DRIFT_PARAM].getValue() * params[DRIFT_PARAM].getValue() * driftVoltage * drift[c/4],
 						-10.f, 10.f),
 						c);
 			}
@@ -128,6 +277,8 @@ struct Drift : Module {
 			json_array_insert_new(divergeJ, i, json_real(diverge[i/4][i%4]));
 		}
 		json_object_set_new(rootJ, "diverge", divergeJ);
+		json_object_set_new(rootJ, "driftSpectrum", json_integer(driftSpectrum));
+		json_object_set_new(rootJ, "busMode", json_boolean(busMode));
 		return rootJ;
 	}
 
@@ -144,6 +295,16 @@ struct Drift : Module {
 				}
 			}
 		}
+		json_t* driftSpectrumJ = json_object_get(rootJ, "driftSpectrum");
+		if (driftSpectrumJ)
+		{
+			driftSpectrum = clamp((int)json_integer_value(driftSpectrumJ), (int)BROWN, (int)PINK);
+		}
+		json_t* busModeJ = json_object_get(rootJ, "busMode");
+		if (busModeJ)
+		{
+			busMode = json_boolean_value(busModeJ);
+		}
 	}
 };
 
@@ -167,6 +328,31 @@ struct DriftWidget : ModuleWidget {
 
 		addOutput(createOutputCentered<ThemedPJ301MPort>(mm2px(Vec(7.62, 112.438)), module, Drift::OUT_OUTPUT));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		Drift* module = getModule<Drift>();
+
+		menu->addChild(new MenuSeparator);
+
+		menu->addChild(createIndexSubmenuItem("Drift spectrum", {"Brown (1/f²)", "Pink (1/f)"},
+			[=]() {
+				return module->driftSpectrum;
+			},
+			[=](int mode) {
+				module->driftSpectrum = mode;
+			}
+		));
+
+		menu->addChild(createBoolMenuItem("Bus mode (share drift with adjacent Drift modules)", "",
+			[=]() {
+				return module->busMode;
+			},
+			[=](int mode) {
+				module->busMode = mode;
+				module->allocateBusLeaderBanks();
+			}
+		));
+	}
 };
 
 
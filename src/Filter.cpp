@@ -0,0 +1,268 @@
+#include "plugin.hpp"
+#include "dsp/commands.hpp"
+#include "dsp/decimator.hpp"
+#include "dsp/filters.hpp"
+
+namespace musx {
+
+using namespace rack;
+using simd::float_4;
+
+struct Filter : Module {
+	enum ParamId {
+		CUTOFF_PARAM,
+		RESONANCE_PARAM,
+		PARAMS_LEN
+	};
+	enum InputId {
+		CUTOFF_INPUT,
+		RESONANCE_INPUT,
+		IN_INPUT,
+		INPUTS_LEN
+	};
+	enum OutputId {
+		OUT_OUTPUT,
+		OUTPUTS_LEN
+	};
+	enum LightId {
+		LIGHTS_LEN
+	};
+
+	enum Mode {
+		SVF_LOWPASS,
+		SVF_BANDPASS,
+		SVF_HIGHPASS,
+		LADDER_6DB,
+		LADDER_12DB,
+		LADDER_18DB,
+		LADDER_24DB,
+		MODES_LEN
+	};
+
+	static const int maxOversamplingRate = 8;
+
+	const float minFreq = 20.f; // min freq [Hz]
+	const float base = 20000.f/minFreq; // max freq/min freq
+	const float log2Base = std::log2(base);
+	const float log2MinFreq = std::log2(minFreq);
+	float log2SampleRate = std::log2(48000.f);
+
+	int mode = LADDER_24DB;
+	int oversamplingRate = 2;
+	float log2OversamplingRate = 1.f;
+
+	int channels = 1;
+
+	musx::TSVF<float_4> svf[4];
+	musx::TFourPole<float_4> ladder[4];
+
+	HalfBandInterpolatorCascade<float_4> interpolator[4];
+	HalfBandDecimatorCascade<float_4> decimator[4];
+
+	dsp::ClockDivider cvDivider;
+
+	// settings from the context menu, applied in process()
+	enum CommandId {
+		SET_MODE,
+		SET_OVERSAMPLING_RATE
+	};
+	musx::CommandQueue<> commands;
+
+	Filter() {
+		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
+		configParam(CUTOFF_PARAM, 0.f, 1.f, 1.f, "Cutoff frequency", " Hz", base, minFreq);
+		configParam(RESONANCE_PARAM, 0.f, 1.f, 0.f, "Resonance", " %", 0.f, 100.f);
+		configInput(CUTOFF_INPUT, "Cutoff frequency CV (1V/Oct)");
+		configInput(RESONANCE_INPUT, "Resonance CV (10V = 100%)");
+		configInput(IN_INPUT, "Audio");
+		configOutput(OUT_OUTPUT, "Filtered");
+
+		cvDivider.setDivision(8);
+
+		configBypass(IN_INPUT, OUT_OUTPUT);
+	}
+
+	void onSampleRateChange(const SampleRateChangeEvent& e) override {
+		log2SampleRate = std::log2(e.sampleRate);
+	}
+
+	void setOversamplingRate(int arg)
+	{
+		oversamplingRate = clamp(arg, 1, maxOversamplingRate);
+		log2OversamplingRate = std::log2(oversamplingRate);
+
+		for (int c = 0; c < 16; c += 4) {
+			svf[c/4].reset();
+			ladder[c/4].reset();
+			interpolator[c/4].reset();
+			decimator[c/4].reset();
+		}
+	}
+
+	void setMode(int arg)
+	{
+		mode = clamp(arg, 0, MODES_LEN - 1);
+
+		for (int c = 0; c < 16; c += 4) {
+			svf[c/4].reset();
+			ladder[c/4].reset();
+		}
+	}
+
+	void applyCommand(const musx::Command& command)
+	{
+		switch (command.id)
+		{
+			case SET_MODE:
+				setMode(command.value);
+				break;
+			case SET_OVERSAMPLING_RATE:
+				setOversamplingRate(command.value);
+				break;
+		}
+	}
+
+	void process(const ProcessArgs& args) override {
+		musx::Command command;
+		while (commands.pop(command))
+		{
+			applyCommand(command);
+		}
+
+		bool cvTick = cvDivider.process();
+		if (cvTick)
+		{
+			channels = std::max(1, inputs[IN_INPUT].getChannels());
+			outputs[OUT_OUTPUT].setChannels(channels);
+		}
+
+		// CV is applied every sample, the knobs alone every 8 samples
+		bool cutoffUpdate = cvTick || inputs[CUTOFF_INPUT].isConnected();
+		bool resonanceUpdate = cvTick || inputs[RESONANCE_INPUT].isConnected();
+		bool isSVF = mode <= SVF_HIGHPASS;
+
+		for (int c = 0; c < channels; c += 4) {
+			if (cutoffUpdate)
+			{
+				float_4 voltage = params[CUTOFF_PARAM].getValue() + 0.1f * inputs[CUTOFF_INPUT].getPolyVoltageSimd<float_4>(c);
+				float_4 f = exp2Fast(log2Base * voltage + log2MinFreq - log2SampleRate - log2OversamplingRate);
+				if (isSVF)
+				{
+					svf[c/4].setCutoffFreq(f);
+				}
+				else
+				{
+					ladder[c/4].setCutoffFreq(f);
+				}
+			}
+
+			if (resonanceUpdate)
+			{
+				float_4 res = simd::clamp(params[RESONANCE_PARAM].getValue() + 0.1f * inputs[RESONANCE_INPUT].getPolyVoltageSimd<float_4>(c), 0.f, 1.f);
+				if (isSVF)
+				{
+					svf[c/4].setResonance(res);
+				}
+				else
+				{
+					// self-oscillation at 4
+					ladder[c/4].setResonance(4.f * res);
+				}
+			}
+		}
+
+		for (int c = 0; c < channels; c += 4) {
+			float_4* buffer = interpolator[c/4].process(inputs[IN_INPUT].getVoltageSimd<float_4>(c), oversamplingRate);
+
+			float_4* out = decimator[c/4].getInputArray(oversamplingRate);
+			switch (mode)
+			{
+				case SVF_LOWPASS:
+					svf[c/4].processBlockLowpass(buffer, out, oversamplingRate);
+					break;
+				case SVF_BANDPASS:
+					svf[c/4].processBlockBandpass(buffer, out, oversamplingRate);
+					break;
+				case SVF_HIGHPASS:
+					svf[c/4].processBlockHighpass(buffer, out, oversamplingRate);
+					break;
+				default:
+					ladder[c/4].processBlock(buffer, out, oversamplingRate, mode - LADDER_6DB);
+			}
+
+			outputs[OUT_OUTPUT].setVoltageSimd(decimator[c/4].process(oversamplingRate), c);
+		}
+	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		json_object_set_new(rootJ, "mode", json_integer(mode));
+		json_object_set_new(rootJ, "oversamplingRate", json_integer(oversamplingRate));
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		json_t* modeJ = json_object_get(rootJ, "mode");
+		if (modeJ)
+		{
+			setMode(json_integer_value(modeJ));
+		}
+		json_t* oversamplingRateJ = json_object_get(rootJ, "oversamplingRate");
+		if (oversamplingRateJ)
+		{
+			setOversamplingRate(json_integer_value(oversamplingRateJ));
+		}
+	}
+};
+
+
+struct FilterWidget : ModuleWidget {
+	FilterWidget(Filter* module) {
+		setModule(module);
+		setPanel(createPanel(asset::plugin(pluginInstance, "res/Filter.svg"), asset::plugin(pluginInstance, "res/Filter-dark.svg")));
+
+		addChild(createWidget<ThemedScrew>(Vec(RACK_GRID_WIDTH, 0)));
+		addChild(createWidget<ThemedScrew>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, 0)));
+		addChild(createWidget<ThemedScrew>(Vec(RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
+		addChild(createWidget<ThemedScrew>(Vec(box.size.x - 2 * RACK_GRID_WIDTH, RACK_GRID_HEIGHT - RACK_GRID_WIDTH)));
+
+		addParam(createParamCentered<RoundBlackKnob>(mm2px(Vec(7.62, 16.062)), module, Filter::CUTOFF_PARAM));
+		addParam(createParamCentered<RoundBlackKnob>(mm2px(Vec(7.62, 48.188)), module, Filter::RESONANCE_PARAM));
+
+		addInput(createInputCentered<ThemedPJ301MPort>(mm2px(Vec(7.62, 32.125)), module, Filter::CUTOFF_INPUT));
+		addInput(createInputCentered<ThemedPJ301MPort>(mm2px(Vec(7.62, 64.25)), module, Filter::RESONANCE_INPUT));
+		addInput(createInputCentered<ThemedPJ301MPort>(mm2px(Vec(7.62, 96.375)), module, Filter::IN_INPUT));
+
+		addOutput(createOutputCentered<ThemedPJ301MPort>(mm2px(Vec(7.62, 112.438)), module, Filter::OUT_OUTPUT));
+	}
+
+	void appendContextMenu(Menu* menu) override {
+		Filter* module = getModule<Filter>();
+
+		menu->addChild(new MenuSeparator);
+
+		menu->addChild(createIndexSubmenuItem("Filter type", {"SVF lowpass", "SVF bandpass", "SVF highpass",
+				"Ladder lowpass 6 dB/Oct", "Ladder lowpass 12 dB/Oct", "Ladder lowpass 18 dB/Oct", "Ladder lowpass 24 dB/Oct"},
+			[=]() {
+				return module->mode;
+			},
+			[=](int mode) {
+				module->commands.push(Filter::SET_MODE, mode);
+			}
+		));
+
+		menu->addChild(createIndexSubmenuItem("Oversampling rate", {"1x", "2x", "4x", "8x"},
+			[=]() {
+				return log2(module->oversamplingRate);
+			},
+			[=](int mode) {
+				module->commands.push(Filter::SET_OVERSAMPLING_RATE, std::pow(2, mode));
+			}
+		));
+	}
+};
+
+
+Model* modelFilter = createModel<Filter, FilterWidget>("Filter");
+
+}
@@ -1,4 +1,6 @@
 #include "plugin.hpp"
+#include "dsp/commands.hpp"
+#include "dsp/governor.hpp"
 
 namespace musx {
 
@@ -36,6 +38,7 @@ struct LFO : Module {
 	int channels = 1;
 
 	int sampleRateReduction = 1;
+	int actualSampleRateReduction = 1;
 	bool bipolar = true;
 
 	// integers overflow, so phase resets automatically
@@ -47,6 +50,16 @@ struct LFO : Module {
 
 	dsp::ClockDivider divider;
 
+	// reduces the sample rate further when the CPU budget is exceeded
+	musx::CpuGovernor governor;
+
+	// settings from the context menu, applied in process()
+	enum CommandId {
+		SET_SAMPLE_RATE_REDUCTION,
+		SET_BIPOLAR
+	};
+	musx::CommandQueue<> commands;
+
 	LFO() {
 		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
 		configSwitch(SHAPE_PARAM, 0.f, 7.f, 0.f, "Shape", {"Sine", "Triangle", "Square", "Pulse", "Ramp", "Saw", "Sample & hold", "Warped"});
@@ -57,16 +70,43 @@ struct LFO : Module {
 		configInput(FREQ_INPUT, "Frequency CV");
 		configInput(AMP_INPUT, "Amplitude CV");
 		configInput(RESET_INPUT, "Reset trigger");
-		configOutput(OUT_OUTPUT, "LFO");
+		CpuGovernorPortInfo* outInfo = configOutput<CpuGovernorPortInfo>(OUT_OUTPUT, "LFO");
+		outInfo->governor = &governor;
+		outInfo->getSetting = [=]() {
+			return string::f("sample rate reduced %dx", actualSampleRateReduction);
+		};
 	}
 
 	void setSampleRateReduction(int arg)
 	{
 		sampleRateReduction = arg;
-		divider.setDivision(sampleRateReduction);
+		governor.maxLevel = 10 - std::log2(sampleRateReduction);
+		actualSampleRateReduction = std::min(sampleRateReduction << governor.level, 1024);
+		divider.setDivision(actualSampleRateReduction);
+	}
+
+	void applyCommand(const musx::Command& command)
+	{
+		switch (command.id)
+		{
+			case SET_SAMPLE_RATE_REDUCTION:
+				setSampleRateReduction(command.value);
+				break;
+			case SET_BIPOLAR:
+				bipolar = command.value;
+				break;
+		}
 	}
 
 	void process(const ProcessArgs& args) override {
+		governor.begin();
+
+		musx::Command command;
+		while (commands.pop(command))
+		{
+			applyCommand(command);
+		}
+
 		if (divider.process())
 		{
 			//
@@ -94,7 +134,7 @@ struct LFO : Module {
 
 				// frequencies, phase increments, factors etc
 				float_4 freq = 2. * dsp::exp2_taylor5(params[FREQ_PARAM].getValue() + inputs[FREQ_INPUT].getPolyVoltageSimd<float_4>(c));
-				int32_4 phaseInc = INT32_MAX / args.sampleRate * freq * sampleRateReduction;
+				int32_4 phaseInc = INT32_MAX / args.sampleRate * freq * actualSampleRateReduction;
 
 				float_4 doSample;
 
@@ -151,12 +191,19 @@ struct LFO : Module {
 			}
 
 		}
+
+		if (governor.end(args.sampleTime))
+		{
+			setSampleRateReduction(sampleRateReduction);
+		}
 	}
 
 	json_t* dataToJson() override {
 		json_t* rootJ = json_object();
 		json_object_set_new(rootJ, "sampleRateReduction", json_integer(sampleRateReduction));
 		json_object_set_new(rootJ, "bipolar", json_boolean(bipolar));
+		json_object_set_new(rootJ, "cpuGovernor", json_boolean(governor.enabled));
+		json_object_set_new(rootJ, "cpuGovernorBudget", json_real(governor.budget));
 		return rootJ;
 	}
 
@@ -171,6 +218,16 @@ struct LFO : Module {
 		{
 			bipolar = json_boolean_value(bipolarJ);
 		}
+		json_t* cpuGovernorJ = json_object_get(rootJ, "cpuGovernor");
+		if (cpuGovernorJ)
+		{
+			governor.setEnabled(json_boolean_value(cpuGovernorJ));
+		}
+		json_t* cpuGovernorBudgetJ = json_object_get(rootJ, "cpuGovernorBudget");
+		if (cpuGovernorBudgetJ)
+		{
+			governor.setBudget(json_real_value(cpuGovernorBudgetJ));
+		}
 	}
 };
 
@@ -207,7 +264,7 @@ struct LFOWidget : ModuleWidget {
 				return log2(module->sampleRateReduction);
 			},
 			[=](int mode) {
-				module->setSampleRateReduction(std::pow(2, mode));
+				module->commands.push(LFO::SET_SAMPLE_RATE_REDUCTION, std::pow(2, mode));
 			}
 		));
 
@@ -216,9 +273,13 @@ struct LFOWidget : ModuleWidget {
 				return module->bipolar;
 			},
 			[=](int mode) {
-				module->bipolar = mode;
+				module->commands.push(LFO::SET_BIPOLAR, mode);
 			}
 		));
+
+		menu->addChild(new MenuSeparator);
+
+		appendCpuGovernorMenu(menu, &module->governor);
 	}
 };
 
@@ -1,4 +1,7 @@
 #include "plugin.hpp"
+#include "dsp/commands.hpp"
+#include "dsp/governor.hpp"
+#include "dsp/matrix.hpp"
 
 namespace musx {
 
@@ -243,6 +246,8 @@ struct ModMatrix : Module {
 		_10_INPUT,
 		_11_INPUT,
 		_12_INPUT,
+		MORPH_INPUT,
+		DEPTH_INPUT,
 		INPUTS_LEN
 	};
 	enum OutputId {
@@ -290,6 +295,141 @@ struct ModMatrix : Module {
 	std::vector<std::vector<Param*>> matrix;
 	std::vector<Output*> outs;
 
+	// expanders: ModMatrix modules to the right of a master module act as tiles of one large matrix
+	static constexpr int maxRowBlocks = 4;
+	static constexpr int maxColumnBlocks = 4;
+
+	// outputs calculated by the master, sent to all expanders. Only the first row block has outputs.
+	struct ExpanderMessage {
+		int channels = 0;
+		bool sendCoefficients = false; // the master requests the coefficients of the tile
+		float_4 out[4][columns] = {};
+	};
+	ExpanderMessage expanderMessages[2];
+
+	// inputs, controls and coefficients of a tile, read by the master
+	struct TileMessage {
+		// signal inputs, used in the first column block
+		int channels = 0;
+		bool inConnected[rows] = {};
+		float_4 in[4][rows] = {};
+
+		// outputs and offsets from the control knob base values, used in the first row block
+		bool outConnected[columns] = {};
+		float offsets[columns] = {};
+
+		// depth CV, 10V = 100%
+		float depth[columns] = {};
+
+		// only included when they changed, or when the master requested them
+		bool hasCoefficients = false;
+		float coefficients[rows][columns] = {};
+		int depthChannels[rows][columns] = {};
+	};
+	TileMessage tileMessages[2];
+	TileMessage ownTile; // the master reads its own tile from here
+
+	int expanderPosition = 0; // 0: standalone or master, else row block * maxColumnBlocks + column block
+	ModMatrix* tiles[maxRowBlocks][maxColumnBlocks] = {};
+	const TileMessage* tileData[maxRowBlocks][maxColumnBlocks] = {};
+
+	// stored scenes, morphed by the morph input
+	static constexpr int numScenes = 8;
+	musx::CoefficientScenes<rows, columns, numScenes> coefficientScenes;
+	bool morphing = false;
+
+	// channel of the depth input which modulates a cell, 0: not modulated
+	int depthChannels[rows][columns] = {};
+
+	static constexpr float coefficientRampTime = 0.01f; // [s]
+	int rampSteps = 1;
+
+	// the knobs are scanned for changes every coefficientScanInterval samples, not on every matrix update
+	static constexpr int coefficientScanInterval = 16;
+	dsp::ClockDivider coefficientDivider;
+	float coefficients[rows][columns] = {};
+	bool coefficientsChanged = true;
+
+	// previous values, to detect changes
+	int prevChannels = 0;
+	float knobBaseVoltages[columns] = {0};
+	float knobCurrentVoltages[columns] = {0};
+
+	// linear interpolation of the outputs between matrix evaluations
+	bool interpolate = true;
+	int interpolationStep = 0;
+
+	// block mode: the inputs are buffered, and the matrix is calculated for a block of samples
+	static constexpr int maxBlockSize = 16;
+	int blockSize = 1; // 1: off
+	int blockPosition = 0;
+	int blockChannels = 0; // channels buffered in the current block
+	bool wasBlockMode = false;
+
+	/**
+	 * State of the matrix calculation of a master, for ROW_BLOCKS x COLUMN_BLOCKS tiles.
+	 * A module without expanders only needs one tile. The state of the full grid is only allocated for masters.
+	 */
+	template <int ROW_BLOCKS, int COLUMN_BLOCKS>
+	struct MatrixState {
+		static constexpr int rowBlocks = ROW_BLOCKS;
+		static constexpr int columnBlocks = COLUMN_BLOCKS;
+		static constexpr int numRows = ROW_BLOCKS * rows;
+		static constexpr int numColumns = COLUMN_BLOCKS * columns;
+
+		musx::CoefficientMatrix<numRows, numColumns> coefficientMatrix;
+		musx::CoefficientRamps<numRows, numColumns> coefficientRamps;
+
+		// tiles whose coefficients were loaded, and tiles whose coefficients are requested
+		ModMatrix* prevTiles[ROW_BLOCKS][COLUMN_BLOCKS] = {};
+		bool needsCoefficients[ROW_BLOCKS][COLUMN_BLOCKS] = {};
+
+		float depthValues[ROW_BLOCKS * COLUMN_BLOCKS * columns] = {};
+
+		// previous values, to detect changes
+		float prevOffsets[numColumns] = {};
+		float_4 prevIns[4][numRows] = {};
+
+		float_4 outValues[4][numColumns] = {}; // current output values of the expanders
+
+		// linear interpolation of the outputs between matrix evaluations
+		bool columnRamping[numColumns] = {};
+		float_4 outStart[4][numColumns] = {};
+		float_4 outDelta[4][numColumns] = {};
+
+		// block mode
+		float_4 inBuffer[4][maxBlockSize][numRows] = {};
+		float_4 outBuffer[4][maxBlockSize][numColumns] = {};
+
+		/**
+		 * continue after the state was not used: the coefficients of the tiles are requested again, the ramps end,
+		 * and all columns are compiled and calculated again. The tiles which were removed meanwhile are cleared.
+		 */
+		void reset()
+		{
+			for (int r = 0; r < ROW_BLOCKS; r++)
+			{
+				for (int cb = 0; cb < COLUMN_BLOCKS; cb++)
+				{
+					needsCoefficients[r][cb] = prevTiles[r][cb];
+				}
+			}
+			coefficientRamps.reset(coefficientMatrix);
+			coefficientMatrix.invalidate();
+			for (int j = 0; j < numColumns; j++)
+			{
+				columnRamping[j] = false;
+			}
+		}
+	};
+	typedef MatrixState<1, 1> TileState;
+	typedef MatrixState<maxRowBlocks, maxColumnBlocks> GridState;
+
+	TileState tileState;
+	// allocated when a ModMatrix is placed to the right, the module may become a master
+	std::atomic<GridState*> gridState {nullptr};
+	bool useGridState = false;
+
 	std::vector<Param*> controlKnobs;
 	std::vector<float> controlKnobBaseValues; // 'base' values of the control knobs when not controlling other rows
 	std::vector<float> currentControlKnobValues;
@@ -300,6 +440,8 @@ struct ModMatrix : Module {
 	size_t prevSelectedControl = 0;
 
 	int sampleRateReduction = 1;
+	int actualSampleRateReduction = 1;
+	float sampleRate = 48000.f;
 	bool latchButtons = false;
 	bool bipolar = true;
 	bool relative = false; // relative midi control mode
@@ -307,6 +449,34 @@ struct ModMatrix : Module {
 	dsp::ClockDivider controlDivider;
 	dsp::ClockDivider matrixDivider;
 
+	// reduces the sample rate further when the CPU budget is exceeded
+	musx::CpuGovernor governor;
+
+	// settings from the context menu, applied in process()
+	enum CommandId {
+		SET_SAMPLE_RATE_REDUCTION,
+		SET_BLOCK_SIZE,
+		SET_INTERPOLATE,
+		SET_BIPOLAR,
+		SET_EXPANDER_POSITION,
+		SET_DEPTH_CHANNEL, // (i * columns + j) << 8 | channel
+		STORE_SCENE,
+		RECALL_SCENE
+	};
+	musx::CommandQueue<> commands;
+
+	// the name depends on the polarity, so that it can change without reconfiguring the input
+	struct KnobBaseValuesPortInfo : PortInfo {
+		std::string getName() override {
+			ModMatrix* matrix = static_cast<ModMatrix*>(module);
+			if (!matrix || matrix->bipolar)
+			{
+				return "Control knob base values (normalled to 5V)";
+			}
+			return "Control knob base values (normalled to 10V)";
+		}
+	};
+
 	ModMatrix() {
 		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
 
@@ -334,6 +504,7 @@ struct ModMatrix : Module {
 			}
 			matrix.push_back(row);
 		}
+		configInput<KnobBaseValuesPortInfo>(_0_INPUT);
 		setPolarity();
 
 		for (size_t i = 0; i < rows; i++)
@@ -343,69 +514,701 @@ struct ModMatrix : Module {
 			getParamQuantity(SEL1_PARAM + i)->randomizeEnabled = false;
 			controlSelectors.push_back(&params[SEL1_PARAM + i]);
 
-			configInput(_1_INPUT + i, "Signal " + std::to_string(i+1));
-			ins.push_back(&inputs[_1_INPUT + i]);
+			configInput(_1_INPUT + i, "Signal " + std::to_string(i+1));
+			ins.push_back(&inputs[_1_INPUT + i]);
+		}
+
+		for (size_t j = 0; j < columns; j++)
+		{
+			CpuGovernorPortInfo* outInfo = configOutput<CpuGovernorPortInfo>(_1_OUTPUT + j, "Mix " + std::to_string(j+1));
+			outInfo->governor = &governor;
+			outInfo->getSetting = [=]() {
+				return string::f("sample rate reduced %dx", actualSampleRateReduction);
+			};
+			outs.push_back(&outputs[_1_OUTPUT + j]);
+		}
+
+		configInput(MORPH_INPUT, "Scene morph (0V to 10V)");
+		configInput(DEPTH_INPUT, "Depth CV (10V = 100%)");
+
+		configOutput(_KNOB_BASE_VALUES_OUTPUT, "Base control knob values");
+		configOutput(_KNOB_CURRENT_VALUES_OUTPUT, "Current control knob values");
+
+		controlDivider.setDivision(1);
+		matrixDivider.setDivision(1);
+		coefficientDivider.setDivision(coefficientScanInterval);
+
+		leftExpander.producerMessage = &expanderMessages[0];
+		leftExpander.consumerMessage = &expanderMessages[1];
+		rightExpander.producerMessage = &tileMessages[0];
+		rightExpander.consumerMessage = &tileMessages[1];
+	}
+
+	~ModMatrix()
+	{
+		delete gridState.load();
+	}
+
+	void setPolarity()
+	{
+		for (size_t j = 0; j < columns; j++)
+		{
+			for (size_t i = 0; i < rows + 1; i++)
+			{
+				size_t iParam = CTRL1_PARAM + i*columns + j;
+				ParamQuantity* qty = paramQuantities[iParam];
+				qty->minValue = -1.f * bipolar;
+				params[iParam].setValue(std::max(qty->minValue, qty->getValue()));
+			}
+		}
+	}
+
+	void setSampleRateReduction(int arg)
+	{
+		int prevSampleRateReduction = actualSampleRateReduction;
+		sampleRateReduction = arg;
+		governor.maxLevel = 10 - std::log2(sampleRateReduction);
+		actualSampleRateReduction = std::min(sampleRateReduction << governor.level, 1024);
+		controlDivider.setDivision(actualSampleRateReduction);
+		matrixDivider.setDivision(actualSampleRateReduction);
+
+		// the output interpolation continues from the same position, and ends with the next matrix update
+		if (prevSampleRateReduction > 1 && actualSampleRateReduction > 1 && actualSampleRateReduction != prevSampleRateReduction)
+		{
+			interpolationStep = clamp(interpolationStep * actualSampleRateReduction / prevSampleRateReduction, 1, actualSampleRateReduction);
+			matrixDivider.clock = interpolationStep - 1;
+		}
+		// coefficients are updated once per block in block mode
+		int updateInterval = actualSampleRateReduction == 1 ? blockSize : actualSampleRateReduction;
+		rampSteps = std::round(coefficientRampTime * sampleRate / updateInterval);
+	}
+
+	void setBlockSize(int arg)
+	{
+		blockSize = clamp(arg, 1, maxBlockSize);
+		setSampleRateReduction(sampleRateReduction);
+	}
+
+	void onSampleRateChange(const SampleRateChangeEvent& e) override
+	{
+		sampleRate = e.sampleRate;
+		setSampleRateReduction(sampleRateReduction);
+	}
+
+	void onReset(const ResetEvent& e) override
+	{
+		Module::onReset(e);
+		for (size_t j = 0; j < columns; j++)
+		{
+			controlKnobBaseValues[j] = 0.;
+			currentControlKnobValues[j] = 0.;
+			previousControlKnobValues[j] = 0.;
+			midiControlKnobValues[j] = -2;
+			previousMidiControlKnobValues[j] = -2;
+		}
+	}
+
+	void onAdd(const AddEvent& e) override
+	{
+		Module::onAdd(e);
+		for (size_t j = 0; j < columns; j++)
+		{
+			controlKnobBaseValues[j] =controlKnobs[j]->getValue();
+			currentControlKnobValues[j] = controlKnobs[j]->getValue();
+			previousControlKnobValues[j] = controlKnobs[j]->getValue();
+			midiControlKnobValues[j] = -2;
+			previousMidiControlKnobValues[j] = -2;
+		}
+	}
+
+	void onExpanderChange(const ExpanderChangeEvent& e) override
+	{
+		Module* module = rightExpander.module;
+		if (module && module->model == modelModMatrix && !gridState.load())
+		{
+			gridState.store(new GridState());
+		}
+	}
+
+	/** the module is a ModMatrix in expander mode */
+	static ModMatrix* getExpander(Module* module)
+	{
+		if (module && module->model == modelModMatrix)
+		{
+			ModMatrix* expander = static_cast<ModMatrix*>(module);
+			if (expander->expanderPosition)
+			{
+				return expander;
+			}
+		}
+		return nullptr;
+	}
+
+	/** in expander mode, the master is the first ModMatrix to the left which is not an expander */
+	ModMatrix* findMaster()
+	{
+		if (!expanderPosition)
+		{
+			return nullptr;
+		}
+
+		Module* module = leftExpander.module;
+		for (int k = 0; k < maxRowBlocks * maxColumnBlocks - 1; k++)
+		{
+			if (!module || module->model != modelModMatrix)
+			{
+				return nullptr;
+			}
+			ModMatrix* modMatrix = static_cast<ModMatrix*>(module);
+			if (!modMatrix->expanderPosition)
+			{
+				return modMatrix;
+			}
+			module = modMatrix->leftExpander.module;
+		}
+		return nullptr;
+	}
+
+	/** collect the expanders to the right. A module without master only uses its own tile. */
+	void findTiles()
+	{
+		for (int r = 0; r < maxRowBlocks; r++)
+		{
+			for (int c = 0; c < maxColumnBlocks; c++)
+			{
+				tiles[r][c] = nullptr;
+			}
+		}
+		tiles[0][0] = this;
+
+		if (expanderPosition)
+		{
+			return;
+		}
+
+		Module* module = rightExpander.module;
+		for (int k = 0; k < maxRowBlocks * maxColumnBlocks - 1; k++)
+		{
+			ModMatrix* expander = getExpander(module);
+			if (!expander)
+			{
+				break;
+			}
+			ModMatrix*& tile = tiles[expander->expanderPosition / maxColumnBlocks][expander->expanderPosition % maxColumnBlocks];
+			if (!tile)
+			{
+				tile = expander;
+			}
+			module = expander->rightExpander.module;
+		}
+	}
+
+	/** coefficient of a cell: from the scene morph if the morph input is connected, else from the knob */
+	inline float getCoefficient(size_t i, size_t j)
+	{
+		return morphing ? coefficientScenes.morphed[i][j] : matrix[i][j]->getValue();
+	}
+
+	/** compare the coefficients with the last scan, mark them changed */
+	void scanCoefficients()
+	{
+		for (size_t i = 0; i < rows; i++)
+		{
+			for (size_t j = 0; j < columns; j++)
+			{
+				float value = getCoefficient(i, j);
+				if (value != coefficients[i][j])
+				{
+					coefficients[i][j] = value;
+					coefficientsChanged = true;
+				}
+			}
+		}
+	}
+
+	void storeScene(int scene)
+	{
+		for (size_t i = 0; i < rows; i++)
+		{
+			for (size_t j = 0; j < columns; j++)
+			{
+				coefficientScenes.setCoeff(scene, i, j, matrix[i][j]->getValue());
+			}
+		}
+	}
+
+	void recallScene(int scene)
+	{
+		for (size_t i = 0; i < rows; i++)
+		{
+			for (size_t j = 0; j < columns; j++)
+			{
+				matrix[i][j]->setValue(coefficientScenes.scenes[scene][i][j]);
+			}
+		}
+	}
+
+	/** signal inputs, for the first column block */
+	void publishInputs(TileMessage* message)
+	{
+		message->channels = 0;
+		for (size_t i = 0; i < rows; i++)
+		{
+			message->inConnected[i] = ins[i]->isConnected();
+			message->channels = std::max(message->channels, ins[i]->getChannels());
+		}
+		for (size_t i = 0; i < rows; i++)
+		{
+			if (message->inConnected[i])
+			{
+				for (int c = 0; c < message->channels; c += 4) {
+					message->in[c/4][i] = ins[i]->getPolyVoltageSimd<float_4>(c);
+				}
+			}
+		}
+	}
+
+	/** connected outputs, offsets from the control knob base values, and depth CV */
+	void publishControls(TileMessage* message)
+	{
+		for (size_t j = 0; j < columns; j++)
+		{
+			message->outConnected[j] = outs[j]->isConnected();
+			message->offsets[j] = inputs[_0_INPUT].isConnected() ? inputs[_0_INPUT].getPolyVoltage(j) :
+					bipolar ? 5. : 10.;
+			message->offsets[j] *= controlKnobBaseValues[j];
+		}
+
+		bool depthConnected = inputs[DEPTH_INPUT].isConnected();
+		for (size_t j = 0; j < columns; j++)
+		{
+			message->depth[j] = depthConnected ? inputs[DEPTH_INPUT].getPolyVoltage(j) / 10.f : 1.f;
+		}
+	}
+
+	/** coefficients and depth channels, if they changed or are requested */
+	void publishCoefficients(TileMessage* message, bool requested)
+	{
+		message->hasCoefficients = coefficientsChanged || requested;
+		if (message->hasCoefficients)
+		{
+			for (size_t i = 0; i < rows; i++)
+			{
+				for (size_t j = 0; j < columns; j++)
+				{
+					message->coefficients[i][j] = coefficients[i][j];
+					message->depthChannels[i][j] = depthChannels[i][j];
+				}
+			}
+			coefficientsChanged = false;
+		}
+	}
+
+	/** the first 16 columns are the own outputs, the others are sent to the expanders */
+	template <typename State>
+	inline void setOutput(State& state, size_t column, int c, float_4 value)
+	{
+		if (column < columns)
+		{
+			outs[column]->setVoltageSimd(value, c);
+		}
+		else
+		{
+			state.outValues[c/4][column] = value;
+		}
+	}
+
+	/** load the coefficients of tiles which sent them, clear the cells of removed tiles */
+	template <typename State>
+	void receiveCoefficients(State& state)
+	{
+		for (int r = 0; r < State::rowBlocks; r++)
+		{
+			for (int cb = 0; cb < State::columnBlocks; cb++)
+			{
+				ModMatrix* tile = tiles[r][cb];
+				if (tile != state.prevTiles[r][cb])
+				{
+					state.prevTiles[r][cb] = tile;
+					state.needsCoefficients[r][cb] = tile;
+					if (!tile)
+					{
+						for (size_t i = 0; i < rows; i++)
+						{
+							for (size_t j = 0; j < columns; j++)
+							{
+								state.coefficientRamps.setTarget(r*rows + i, cb*columns + j, 0.f, state.coefficientMatrix);
+								state.coefficientMatrix.setDepthIndex(r*rows + i, cb*columns + j, 0);
+							}
+						}
+					}
+				}
+
+				if (tile == this)
+				{
+					publishCoefficients(&ownTile, state.needsCoefficients[r][cb]);
+				}
+
+				const TileMessage* message = tileData[r][cb];
+				if (!message || !message->hasCoefficients)
+				{
+					continue;
+				}
+
+				int tileIndex = r*State::columnBlocks + cb;
+				for (size_t i = 0; i < rows; i++)
+				{
+					for (size_t j = 0; j < columns; j++)
+					{
+						state.coefficientRamps.setTarget(r*rows + i, cb*columns + j, message->coefficients[i][j], state.coefficientMatrix);
+
+						// depth index of the cell: depth channel of the tile + 1
+						int depthChannel = message->depthChannels[i][j];
+						state.coefficientMatrix.setDepthIndex(r*rows + i, cb*columns + j, depthChannel ? tileIndex*columns + depthChannel : 0);
+					}
+				}
+				state.needsCoefficients[r][cb] = false;
+			}
+		}
+	}
+
+	/** update the coefficients (ramped) and the depth of all tiles, recompile changed columns */
+	template <typename State>
+	void updateCoefficients(State& state)
+	{
+		state.coefficientRamps.setRampSteps(rampSteps);
+		state.coefficientRamps.process(state.coefficientMatrix);
+
+		for (int r = 0; r < State::rowBlocks; r++)
+		{
+			for (int cb = 0; cb < State::columnBlocks; cb++)
+			{
+				const TileMessage* message = tileData[r][cb];
+				int tileIndex = r*State::columnBlocks + cb;
+				for (size_t k = 0; k < columns; k++)
+				{
+					state.depthValues[tileIndex*columns + k] = message ? message->depth[k] : 1.f;
+				}
+			}
+		}
+
+		// inputs of the first column block, outputs of the first row block
+		for (int i = 0; i < State::numRows; i++)
+		{
+			const TileMessage* message = tileData[i / rows][0];
+			state.coefficientMatrix.setRowActive(i, message && message->inConnected[i % rows]);
+		}
+		for (int j = 0; j < State::numColumns; j++)
+		{
+			const TileMessage* message = tileData[0][j / columns];
+			state.coefficientMatrix.setColumnActive(j, message && message->outConnected[j % columns]);
+		}
+		state.coefficientMatrix.compile();
+		state.coefficientMatrix.setDepth(state.depthValues);
+	}
+
+	/** offsets of the outputs from the control knob base values, mark changed columns */
+	template <typename State>
+	void updateOffsets(State& state, float* offsets)
+	{
+		for (int j = 0; j < State::numColumns; j++)
+		{
+			const TileMessage* message = tileData[0][j / columns];
+			offsets[j] = message ? message->offsets[j % columns] : 0.f;
+
+			if (offsets[j] != state.prevOffsets[j])
+			{
+				state.prevOffsets[j] = offsets[j];
+				state.coefficientMatrix.setColumnDirty(j);
+			}
+		}
+	}
+
+	/** the number of channels is the maximum of the inputs of the first column block */
+	void updateChannels()
+	{
+		channels = 0;
+		for (int r = 0; r < maxRowBlocks; r++)
+		{
+			if (tileData[r][0])
+			{
+				channels = std::max(channels, tileData[r][0]->channels);
+			}
+		}
+
+		for (auto& out : outs)
+		{
+			out->setChannels(channels);
+		}
+	}
+
+	/** input of a row of the first column block, 0 if the row or the channel group is not connected */
+	inline float_4 getInput(int row, int c)
+	{
+		const TileMessage* message = tileData[row / rows][0];
+		if (message && message->inConnected[row % rows] && c < message->channels)
+		{
+			return message->in[c/4][row % rows];
+		}
+		return 0.f;
+	}
+
+	/** block mode: buffer the inputs, output the block calculated before, and calculate the next block when the buffer is full */
+	template <typename State>
+	void processBlockMode(State& state)
+	{
+		if (!wasBlockMode)
+		{
+			blockPosition = 0;
+			blockChannels = 0;
+		}
+		wasBlockMode = true;
+		int b = blockPosition;
+
+		// the own tile is only read when it is needed
+		publishInputs(&ownTile);
+		updateChannels();
+
+		// channel groups added during the block have no inputs and outputs before
+		for (int c = (blockChannels + 3) / 4 * 4; c < channels; c += 4) {
+			for (int k = 0; k < maxBlockSize; k++)
+			{
+				for (int i = 0; i < State::numRows; i++)
+				{
+					state.inBuffer[c/4][k][i] = 0.f;
+				}
+				for (int j = 0; j < State::numColumns; j++)
+				{
+					state.outBuffer[c/4][k][j] = 0.f;
+				}
+			}
+		}
+		blockChannels = std::max(blockChannels, channels);
+
+		// the rows connected during the block are only activated at its end
+		for (int i = 0; i < State::numRows; i++)
+		{
+			for (int c = 0; c < channels; c += 4) {
+				state.inBuffer[c/4][b][i] = getInput(i, c);
+			}
+		}
+
+		for (int j = 0; j < State::numColumns; j++)
+		{
+			if (state.coefficientMatrix.columnActive[j])
+			{
+				for (int c = 0; c < channels; c += 4) {
+					setOutput(state, j, c, state.outBuffer[c/4][b][j]);
+				}
+			}
+		}
+
+		if (++blockPosition < blockSize)
+		{
+			return;
+		}
+		int n = blockPosition;
+		blockPosition = 0;
+		blockChannels = channels;
+
+		publishControls(&ownTile);
+		updateCoefficients(state);
+		float offsets[State::numColumns] = {0};
+		updateOffsets(state, offsets);
+
+		for (int c = 0; c < channels; c += 4) {
+			for (int k = 0; k < n; k++)
+			{
+				for (int j = 0; j < State::numColumns; j++)
+				{
+					state.outBuffer[c/4][k][j] = offsets[j];
+				}
+			}
+
+			state.coefficientMatrix.template processBlock<maxBlockSize>(&state.inBuffer[c/4][0][0], &state.outBuffer[c/4][0][0], n);
+
+			for (int k = 0; k < n; k++)
+			{
+				for (int j = 0; j < State::numColumns; j++)
+				{
+					state.outBuffer[c/4][k][j] = simd::clamp(state.outBuffer[c/4][k][j], -12.f, 12.f);
+				}
+			}
+		}
+
+		state.coefficientMatrix.clearDirty();
+	}
+
+	/** calculate the matrix at the (reduced) sample rate, interpolate the outputs in between */
+	template <typename State>
+	void processMatrix(State& state)
+	{
+		if (matrixDivider.process())
+		{
+			// the own tile is only read when it is needed
+			publishInputs(&ownTile);
+			publishControls(&ownTile);
+			updateChannels();
+
+			updateCoefficients(state);
+
+			// no interpolation from stale values when the number of channels changes
+			bool snap = !interpolate || actualSampleRateReduction == 1;
+			if (channels != prevChannels || wasBlockMode)
+			{
+				prevChannels = channels;
+				wasBlockMode = false;
+				state.coefficientMatrix.setAllDirty();
+				snap = true;
+			}
+
+			// control knob base values
+			float offsets[State::numColumns] = {0};
+			updateOffsets(state, offsets);
+
+			// inputs, detect static inputs
+			float_4 in[4][State::numRows];
+			for (int i = 0; i < State::numRows; i++)
+			{
+				bool rowChanged = false;
+				for (int c = 0; c < channels; c += 4) {
+					in[c/4][i] = getInput(i, c);
+					rowChanged |= simd::movemask(in[c/4][i] != state.prevIns[c/4][i]);
+					state.prevIns[c/4][i] = in[c/4][i];
+				}
+
+				if (rowChanged)
+				{
+					state.coefficientMatrix.setRowDirty(i);
+				}
+			}
+
+			// all tiles are calculated in one pass
+			for (int c = 0; c < channels; c += 4) {
+				float_4 out[State::numColumns];
+				for (int j = 0; j < State::numColumns; j++)
+				{
+					out[j] = offsets[j];
+				}
+
+				state.coefficientMatrix.process(in[c/4], out);
+
+				for (int j = 0; j < State::numColumns; j++)
+				{
+					// the previous ramp has reached its target
+					state.outStart[c/4][j] += state.outDelta[c/4][j];
+					state.outDelta[c/4][j] = 0.f;
+					if (snap && state.columnRamping[j])
+					{
+						// interpolation was switched off during a ramp
+						setOutput(state, j, c, state.outStart[c/4][j]);
+					}
+
+					if (state.coefficientMatrix.columnNeedsUpdate(j))
+					{
+						float_4 target = simd::clamp(out[j], -12.f, 12.f);
+						if (snap)
+						{
+							state.outStart[c/4][j] = target;
+							setOutput(state, j, c, target);
+						}
+						else
+						{
+							state.outDelta[c/4][j] = target - state.outStart[c/4][j];
+						}
+					}
+				}
+			}
+
+			for (int j = 0; j < State::numColumns; j++)
+			{
+				state.columnRamping[j] = !snap && state.coefficientMatrix.columnNeedsUpdate(j);
+			}
+			interpolationStep = 0;
+
+			state.coefficientMatrix.clearDirty();
 		}
 
-		for (size_t j = 0; j < columns; j++)
+		// interpolate outputs
+		if (interpolate && actualSampleRateReduction > 1)
 		{
-			configOutput(_1_OUTPUT + j, "Mix " + std::to_string(j+1));
-			outs.push_back(&outputs[_1_OUTPUT + j]);
+			interpolationStep = std::min(interpolationStep + 1, actualSampleRateReduction);
+			float_4 phase = 1.f * interpolationStep / actualSampleRateReduction;
+			for (int j = 0; j < State::numColumns; j++)
+			{
+				if (state.columnRamping[j])
+				{
+					for (int c = 0; c < channels; c += 4) {
+						setOutput(state, j, c, state.outStart[c/4][j] + phase * state.outDelta[c/4][j]);
+					}
+				}
+			}
 		}
-
-		configOutput(_KNOB_BASE_VALUES_OUTPUT, "Base control knob values");
-		configOutput(_KNOB_CURRENT_VALUES_OUTPUT, "Current control knob values");
-
-		controlDivider.setDivision(1);
-		matrixDivider.setDivision(1);
 	}
 
-	void setPolarity()
+	/** master: read the tiles, calculate the matrix, send the outputs and coefficient requests to the expanders */
+	template <typename State>
+	void processMaster(State& state)
 	{
-		if (bipolar)
+		for (int r = 0; r < maxRowBlocks; r++)
 		{
-			configInput(_0_INPUT, "Control knob base values (normalled to 5V)");
+			for (int cb = 0; cb < maxColumnBlocks; cb++)
+			{
+				ModMatrix* tile = tiles[r][cb];
+				if (r >= State::rowBlocks || cb >= State::columnBlocks || !tile)
+				{
+					tileData[r][cb] = nullptr;
+				}
+				else if (tile == this)
+				{
+					tileData[r][cb] = &ownTile;
+				}
+				else
+				{
+					tileData[r][cb] = (const TileMessage*) tile->rightExpander.consumerMessage;
+				}
+			}
+		}
+
+		receiveCoefficients(state);
+
+		if (blockSize > 1 && actualSampleRateReduction == 1)
+		{
+			processBlockMode(state);
 		}
 		else
 		{
-			configInput(_0_INPUT, "Control knob base values (normalled to 10V)");
+			processMatrix(state);
 		}
 
-		for (size_t j = 0; j < columns; j++)
+		// send outputs to the expanders of the first row block, coefficient requests to all expanders
+		for (int r = 0; r < State::rowBlocks; r++)
 		{
-			for (size_t i = 0; i < rows + 1; i++)
+			for (int cb = 0; cb < State::columnBlocks; cb++)
 			{
-				size_t iParam = CTRL1_PARAM + i*columns + j;
-				ParamQuantity* qty = paramQuantities[iParam];
-				qty->minValue = -1.f * bipolar;
-				params[iParam].setValue(std::max(qty->minValue, qty->getValue()));
-			}
-		}
-	}
-
-	void setSampleRateReduction(int arg)
-	{
-		sampleRateReduction = arg;
-		controlDivider.setDivision(sampleRateReduction);
-		matrixDivider.setDivision(sampleRateReduction);
-	}
+				ModMatrix* tile = tiles[r][cb];
+				if (!tile || tile == this)
+				{
+					continue;
+				}
 
-	void onReset(const ResetEvent& e) override
-	{
-		Module::onReset(e);
-		for (size_t j = 0; j < columns; j++)
-		{
-			controlKnobBaseValues[j] = 0.;
-			currentControlKnobValues[j] = 0.;
-			previousControlKnobValues[j] = 0.;
-			midiControlKnobValues[j] = -2;
-			previousMidiControlKnobValues[j] = -2;
+				ExpanderMessage* message = (ExpanderMessage*) tile->leftExpander.producerMessage;
+				message->channels = r ? 0 : channels;
+				message->sendCoefficients = state.needsCoefficients[r][cb];
+				for (int c = 0; c < message->channels; c += 4) {
+					for (size_t j = 0; j < columns; j++)
+					{
+						message->out[c/4][j] = state.outValues[c/4][cb*columns + j];
+					}
+				}
+				tile->leftExpander.requestMessageFlip();
+			}
 		}
 	}
 
-	void onAdd(const AddEvent& e) override
+	void onRandomize(const RandomizeEvent& e) override
 	{
-		Module::onAdd(e);
+		Module::onRandomize(e);
 		for (size_t j = 0; j < columns; j++)
 		{
 			controlKnobBaseValues[j] =controlKnobs[j]->getValue();
@@ -416,38 +1219,70 @@ struct ModMatrix : Module {
 		}
 	}
 
-	void onRandomize(const RandomizeEvent& e) override
+	void applyCommand(const musx::Command& command)
 	{
-		Module::onRandomize(e);
-		for (size_t j = 0; j < columns; j++)
+		switch (command.id)
 		{
-			controlKnobBaseValues[j] =controlKnobs[j]->getValue();
-			currentControlKnobValues[j] = controlKnobs[j]->getValue();
-			previousControlKnobValues[j] = controlKnobs[j]->getValue();
-			midiControlKnobValues[j] = -2;
-			previousMidiControlKnobValues[j] = -2;
+			case SET_SAMPLE_RATE_REDUCTION:
+				setSampleRateReduction(command.value);
+				break;
+			case SET_BLOCK_SIZE:
+				setBlockSize(command.value);
+				break;
+			case SET_INTERPOLATE:
+				interpolate = command.value;
+				break;
+			case SET_BIPOLAR:
+				bipolar = command.value;
+				setPolarity();
+				break;
+			case SET_EXPANDER_POSITION:
+				expanderPosition = clamp(command.value, 0, maxRowBlocks * maxColumnBlocks - 1);
+				break;
+			case SET_DEPTH_CHANNEL:
+			{
+				int cell = command.value >> 8;
+				depthChannels[cell / columns][cell % columns] = clamp(command.value & 0xff, 0, (int)columns);
+				coefficientsChanged = true;
+				break;
+			}
+			case STORE_SCENE:
+				storeScene(command.value);
+				break;
+			case RECALL_SCENE:
+				recallScene(command.value);
+				break;
 		}
 	}
 
 	void process(const ProcessArgs& args) override
 	{
-		if (controlDivider.process())
+		governor.begin();
+
+		musx::Command command;
+		while (commands.pop(command))
 		{
-			//
-			// channels
-			//
-			channels = 0;
+			applyCommand(command);
+		}
 
-			for (auto& in : ins)
-			{
-				channels = std::max(channels, in->getChannels());
-			}
+		processTile(args);
 
-			for (auto& out : outs)
-			{
-				out->setChannels(channels);
-			}
+		if (governor.end(args.sampleTime))
+		{
+			setSampleRateReduction(sampleRateReduction);
+		}
+	}
+
+	void processTile(const ProcessArgs& args)
+	{
+		ModMatrix* master = findMaster();
+		if (!master)
+		{
+			findTiles();
+		}
 
+		if (controlDivider.process())
+		{
 			outputs[_KNOB_BASE_VALUES_OUTPUT].setChannels(columns);
 			outputs[_KNOB_CURRENT_VALUES_OUTPUT].setChannels(columns);
 
@@ -566,42 +1401,102 @@ struct ModMatrix : Module {
 				previousMidiControlKnobValues[j] = midiControlKnobValues[j];
 				previousControlKnobValues[j] = currentControlKnobValues[j];
 			}
+
+			// scene morph
+			morphing = inputs[MORPH_INPUT].isConnected();
+			if (morphing)
+			{
+				float position = clamp(inputs[MORPH_INPUT].getVoltage(), 0.f, 10.f) * (numScenes - 1) / 10.f;
+				coefficientScenes.morph(position);
+			}
+
+			// knob values output, only written on change
+			for (size_t j = 0; j < columns; j++)
+			{
+				float baseVoltage = controlKnobBaseValues[j] * (bipolar ? 5. : 10.);
+				if (baseVoltage != knobBaseVoltages[j])
+				{
+					knobBaseVoltages[j] = baseVoltage;
+					outputs[_KNOB_BASE_VALUES_OUTPUT].setVoltage(baseVoltage, j);
+				}
+
+				float currentVoltage = currentControlKnobValues[j] * (bipolar ? 5. : 10.);
+				if (currentVoltage != knobCurrentVoltages[j])
+				{
+					knobCurrentVoltages[j] = currentVoltage;
+					outputs[_KNOB_CURRENT_VALUES_OUTPUT].setVoltage(currentVoltage, j);
+				}
+			}
 		}
 
-		// knob values output
-		for (size_t j = 0; j < columns; j++)
+		if (coefficientDivider.process())
 		{
-			outputs[_KNOB_BASE_VALUES_OUTPUT].setVoltage(controlKnobBaseValues[j] * (bipolar ? 5. : 10.), j);
-			outputs[_KNOB_CURRENT_VALUES_OUTPUT].setVoltage(currentControlKnobValues[j] * (bipolar ? 5. : 10.), j);
+			scanCoefficients();
 		}
 
 		//
-		// calc matrix
+		// expander with master: outputs are calculated by the master
 		//
-		if (matrixDivider.process())
+		if (master)
 		{
-			for (int c = 0; c < channels; c += 4) {
-				// loop over outs
-				for (size_t j = 0; j < columns; j++)
-				{
-					Output* out = outs[j];
-					if (out->isConnected())
-					{
-						// loop over ins, multiply with params
-						float_4 val = inputs[_0_INPUT].isConnected() ? inputs[_0_INPUT].getPolyVoltage(j) :
-								bipolar ? 5. : 10.;
-						val *= controlKnobBaseValues[j];
+			ExpanderMessage* message = (ExpanderMessage*) leftExpander.consumerMessage;
+			for (size_t j = 0; j < columns; j++)
+			{
+				outs[j]->setChannels(message->channels);
+				for (int c = 0; c < message->channels; c += 4) {
+					outs[j]->setVoltageSimd(message->out[c/4][j], c);
+				}
+			}
 
-						for (size_t i = 0; i < rows; i++)
-						{
-							Input* in = ins[i];
-							val += in->getPolyVoltageSimd<float_4>(c) * matrix[i][j]->getValue();
-						}
+			// publish the tile, the master reads it in the next sample
+			TileMessage* tile = (TileMessage*) rightExpander.producerMessage;
+			if (expanderPosition % maxColumnBlocks == 0)
+			{
+				publishInputs(tile);
+			}
+			publishControls(tile);
+			publishCoefficients(tile, message->sendCoefficients);
+			rightExpander.requestMessageFlip();
+
+			// no stale outputs and requests when the master stops sending
+			message->channels = 0;
+			message->sendCoefficients = false;
+			return;
+		}
 
-						out->setVoltageSimd(simd::clamp(val, -12.f, 12.f), c);
-					}
-				}
+		//
+		// calc matrix
+		//
+		bool hasExpanders = false;
+		for (int k = 1; k < maxRowBlocks * maxColumnBlocks; k++)
+		{
+			hasExpanders |= tiles[k / maxColumnBlocks][k % maxColumnBlocks] != nullptr;
+		}
+
+		// the state of the full grid is allocated with the first ModMatrix placed to the right
+		GridState* grid = gridState.load();
+		if (useGridState != (hasExpanders && grid))
+		{
+			useGridState = hasExpanders && grid;
+			if (useGridState)
+			{
+				grid->reset();
+			}
+			else
+			{
+				tileState.reset();
 			}
+			prevChannels = -1;
+			wasBlockMode = false;
+		}
+
+		if (useGridState)
+		{
+			processMaster(*grid);
+		}
+		else
+		{
+			processMaster(tileState);
 		}
 	}
 
@@ -611,6 +1506,36 @@ struct ModMatrix : Module {
 		json_object_set_new(rootJ, "latchButtons", json_boolean(latchButtons));
 		json_object_set_new(rootJ, "bipolar", json_boolean(bipolar));
 		json_object_set_new(rootJ, "relative", json_boolean(relative));
+		json_object_set_new(rootJ, "interpolate", json_boolean(interpolate));
+		json_object_set_new(rootJ, "expanderPosition", json_integer(expanderPosition));
+		json_object_set_new(rootJ, "blockSize", json_integer(blockSize));
+		json_object_set_new(rootJ, "cpuGovernor", json_boolean(governor.enabled));
+		json_object_set_new(rootJ, "cpuGovernorBudget", json_real(governor.budget));
+
+		json_t* scenesJ = json_array();
+		for (int k = 0; k < numScenes; k++)
+		{
+			json_t* sceneJ = json_array();
+			for (size_t i = 0; i < rows; i++)
+			{
+				for (size_t j = 0; j < columns; j++)
+				{
+					json_array_append_new(sceneJ, json_real(coefficientScenes.scenes[k][i][j]));
+				}
+			}
+			json_array_append_new(scenesJ, sceneJ);
+		}
+		json_object_set_new(rootJ, "scenes", scenesJ);
+
+		json_t* depthChannelsJ = json_array();
+		for (size_t i = 0; i < rows; i++)
+		{
+			for (size_t j = 0; j < columns; j++)
+			{
+				json_array_append_new(depthChannelsJ, json_integer(depthChannels[i][j]));
+			}
+		}
+		json_object_set_new(rootJ, "depthChannels", depthChannelsJ);
 		return rootJ;
 	}
 
@@ -637,11 +1562,107 @@ struct ModMatrix : Module {
 			relative = json_boolean_value(relativeJ);
 			setPolarity();
 		}
+		json_t* interpolateJ = json_object_get(rootJ, "interpolate");
+		if (interpolateJ)
+		{
+			interpolate = json_boolean_value(interpolateJ);
+		}
+		json_t* expanderPositionJ = json_object_get(rootJ, "expanderPosition");
+		if (expanderPositionJ)
+		{
+			expanderPosition = clamp((int)json_integer_value(expanderPositionJ), 0, maxRowBlocks * maxColumnBlocks - 1);
+		}
+		json_t* blockSizeJ = json_object_get(rootJ, "blockSize");
+		if (blockSizeJ)
+		{
+			setBlockSize(json_integer_value(blockSizeJ));
+		}
+		json_t* cpuGovernorJ = json_object_get(rootJ, "cpuGovernor");
+		if (cpuGovernorJ)
+		{
+			governor.setEnabled(json_boolean_value(cpuGovernorJ));
+		}
+		json_t* cpuGovernorBudgetJ = json_object_get(rootJ, "cpuGovernorBudget");
+		if (cpuGovernorBudgetJ)
+		{
+			governor.setBudget(json_real_value(cpuGovernorBudgetJ));
+		}
+		json_t* scenesJ = json_object_get(rootJ, "scenes");
+		if (scenesJ)
+		{
+			for (int k = 0; k < numScenes; k++)
+			{
+				json_t* sceneJ = json_array_get(scenesJ, k);
+				if (!sceneJ)
+				{
+					continue;
+				}
+				for (size_t i = 0; i < rows; i++)
+				{
+					for (size_t j = 0; j < columns; j++)
+					{
+						json_t* coeffJ = json_array_get(sceneJ, i*columns + j);
+						if (coeffJ)
+						{
+							coefficientScenes.setCoeff(k, i, j, json_real_value(coeffJ));
+						}
+					}
+				}
+			}
+		}
+		json_t* depthChannelsJ = json_object_get(rootJ, "depthChannels");
+		if (depthChannelsJ)
+		{
+			for (size_t i = 0; i < rows; i++)
+			{
+				for (size_t j = 0; j < columns; j++)
+				{
+					json_t* depthChannelJ = json_array_get(depthChannelsJ, i*columns + j);
+					if (depthChannelJ)
+					{
+						depthChannels[i][j] = clamp((int)json_integer_value(depthChannelJ), 0, (int)columns);
+					}
+				}
+			}
+		}
+	}
+};
+
+
+/** matrix knob, with a context menu to assign a channel of the depth input to the cell */
+struct DepthTrimpot : Trimpot {
+	void appendContextMenu(Menu* menu) override {
+		ModMatrix* module = dynamic_cast<ModMatrix*>(this->module);
+		if (!module)
+		{
+			return;
+		}
+
+		size_t i = (paramId - ModMatrix::_1_1_PARAM) / ModMatrix::columns;
+		size_t j = (paramId - ModMatrix::_1_1_PARAM) % ModMatrix::columns;
+
+		std::vector<std::string> channels = {"Off"};
+		for (size_t k = 1; k <= ModMatrix::columns; k++)
+		{
+			channels.push_back(std::to_string(k));
+		}
+
+		menu->addChild(new MenuSeparator);
+		menu->addChild(createIndexSubmenuItem("Depth CV channel", channels,
+			[=]() {
+				return module->depthChannels[i][j];
+			},
+			[=](int channel) {
+				module->commands.push(ModMatrix::SET_DEPTH_CHANNEL, (i * ModMatrix::columns + j) << 8 | channel);
+			}
+		));
 	}
 };
 
 
 struct ModMatrixWidget : ModuleWidget {
+	bool bipolar = true;
+
 	ModMatrixWidget(ModMatrix* module) {
 		setModule(module);
 		setPanel(createPanel(asset::plugin(pluginInstance, "res/ModMatrix.svg"), asset::plugin(pluginInstance, "res/ModMatrix-dark.svg")));
@@ -667,198 +1688,198 @@ struct ModMatrixWidget : ModuleWidget {
 		addParam(createParamCentered<RoundSmallBlackKnob>(mm2px(Vec(120.316, 8.29)), module, ModMatrix::CTRL14_PARAM));
 		addParam(createParamCentered<RoundSmallBlackKnob>(mm2px(Vec(128.337, 8.29)), module, ModMatrix::CTRL15_PARAM));
 		addParam(createParamCentered<RoundSmallBlackKnob>(mm2px(Vec(136.358, 8.29)), module, ModMatrix::CTRL16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 18.601)), module, ModMatrix::_1_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 18.601)), module, ModMatrix::_1_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 18.601)), module, ModMatrix::_1_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 18.601)), module, ModMatrix::_1_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 18.601)), module, ModMatrix::_1_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 18.601)), module, ModMatrix::_1_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 18.601)), module, ModMatrix::_1_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 18.601)), module, ModMatrix::_1_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 18.601)), module, ModMatrix::_1_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 18.601)), module, ModMatrix::_1_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 18.601)), module, ModMatrix::_1_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 18.601)), module, ModMatrix::_1_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 18.6)), module, ModMatrix::_1_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 18.601)), module, ModMatrix::_1_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 18.601)), module, ModMatrix::_1_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 18.601)), module, ModMatrix::_1_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 26.89)), module, ModMatrix::_2_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 26.891)), module, ModMatrix::_2_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 26.89)), module, ModMatrix::_2_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 26.891)), module, ModMatrix::_2_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 26.891)), module, ModMatrix::_2_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 26.891)), module, ModMatrix::_2_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 26.891)), module, ModMatrix::_2_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 26.891)), module, ModMatrix::_2_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 26.891)), module, ModMatrix::_2_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 26.89)), module, ModMatrix::_2_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 26.891)), module, ModMatrix::_2_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 26.891)), module, ModMatrix::_2_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 26.89)), module, ModMatrix::_2_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 26.891)), module, ModMatrix::_2_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 26.891)), module, ModMatrix::_2_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 26.891)), module, ModMatrix::_2_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 35.181)), module, ModMatrix::_3_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 35.182)), module, ModMatrix::_3_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 35.181)), module, ModMatrix::_3_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 35.182)), module, ModMatrix::_3_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 35.182)), module, ModMatrix::_3_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 35.182)), module, ModMatrix::_3_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 35.182)), module, ModMatrix::_3_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 35.182)), module, ModMatrix::_3_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 35.182)), module, ModMatrix::_3_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 35.182)), module, ModMatrix::_3_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 35.182)), module, ModMatrix::_3_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 35.182)), module, ModMatrix::_3_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 35.181)), module, ModMatrix::_3_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 35.182)), module, ModMatrix::_3_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 35.182)), module, ModMatrix::_3_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 35.182)), module, ModMatrix::_3_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 43.471)), module, ModMatrix::_4_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 43.472)), module, ModMatrix::_4_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 43.471)), module, ModMatrix::_4_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 43.472)), module, ModMatrix::_4_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 43.472)), module, ModMatrix::_4_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 43.472)), module, ModMatrix::_4_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 43.472)), module, ModMatrix::_4_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 43.472)), module, ModMatrix::_4_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 43.472)), module, ModMatrix::_4_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 43.472)), module, ModMatrix::_4_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 43.472)), module, ModMatrix::_4_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 43.472)), module, ModMatrix::_4_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 43.471)), module, ModMatrix::_4_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 43.472)), module, ModMatrix::_4_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 43.472)), module, ModMatrix::_4_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 43.472)), module, ModMatrix::_4_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 51.762)), module, ModMatrix::_5_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 51.762)), module, ModMatrix::_5_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 51.761)), module, ModMatrix::_5_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 51.762)), module, ModMatrix::_5_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 51.762)), module, ModMatrix::_5_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 51.762)), module, ModMatrix::_5_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 51.762)), module, ModMatrix::_5_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 51.762)), module, ModMatrix::_5_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 51.762)), module, ModMatrix::_5_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 51.763)), module, ModMatrix::_5_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 51.763)), module, ModMatrix::_5_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 51.763)), module, ModMatrix::_5_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 51.762)), module, ModMatrix::_5_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 51.763)), module, ModMatrix::_5_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 51.763)), module, ModMatrix::_5_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 51.763)), module, ModMatrix::_5_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 60.053)), module, ModMatrix::_6_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 60.053)), module, ModMatrix::_6_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 60.052)), module, ModMatrix::_6_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 60.053)), module, ModMatrix::_6_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 60.053)), module, ModMatrix::_6_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 60.053)), module, ModMatrix::_6_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 60.053)), module, ModMatrix::_6_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 60.053)), module, ModMatrix::_6_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 60.053)), module, ModMatrix::_6_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 60.053)), module, ModMatrix::_6_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 60.053)), module, ModMatrix::_6_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 60.053)), module, ModMatrix::_6_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 60.052)), module, ModMatrix::_6_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 60.053)), module, ModMatrix::_6_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 60.053)), module, ModMatrix::_6_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 60.053)), module, ModMatrix::_6_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 68.342)), module, ModMatrix::_7_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 68.342)), module, ModMatrix::_7_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 68.341)), module, ModMatrix::_7_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 68.342)), module, ModMatrix::_7_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 68.342)), module, ModMatrix::_7_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 68.342)), module, ModMatrix::_7_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 68.342)), module, ModMatrix::_7_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 68.342)), module, ModMatrix::_7_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 68.342)), module, ModMatrix::_7_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 68.343)), module, ModMatrix::_7_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 68.343)), module, ModMatrix::_7_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 68.343)), module, ModMatrix::_7_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 68.342)), module, ModMatrix::_7_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 68.343)), module, ModMatrix::_7_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 68.343)), module, ModMatrix::_7_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 68.343)), module, ModMatrix::_7_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 76.632)), module, ModMatrix::_8_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 76.632)), module, ModMatrix::_8_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 76.631)), module, ModMatrix::_8_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 76.632)), module, ModMatrix::_8_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 76.632)), module, ModMatrix::_8_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 76.632)), module, ModMatrix::_8_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 76.632)), module, ModMatrix::_8_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 76.632)), module, ModMatrix::_8_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 76.632)), module, ModMatrix::_8_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 76.633)), module, ModMatrix::_8_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 76.633)), module, ModMatrix::_8_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 76.633)), module, ModMatrix::_8_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 76.632)), module, ModMatrix::_8_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 76.633)), module, ModMatrix::_8_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 76.633)), module, ModMatrix::_8_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 76.633)), module, ModMatrix::_8_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 84.923)), module, ModMatrix::_9_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 84.923)), module, ModMatrix::_9_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 84.922)), module, ModMatrix::_9_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 84.923)), module, ModMatrix::_9_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 84.923)), module, ModMatrix::_9_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 84.923)), module, ModMatrix::_9_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 84.923)), module, ModMatrix::_9_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 84.923)), module, ModMatrix::_9_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 84.923)), module, ModMatrix::_9_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 84.923)), module, ModMatrix::_9_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 84.923)), module, ModMatrix::_9_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 84.923)), module, ModMatrix::_9_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 84.922)), module, ModMatrix::_9_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 84.923)), module, ModMatrix::_9_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 84.923)), module, ModMatrix::_9_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 84.923)), module, ModMatrix::_9_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 93.212)), module, ModMatrix::_10_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 93.213)), module, ModMatrix::_10_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 93.212)), module, ModMatrix::_10_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 93.213)), module, ModMatrix::_10_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 93.213)), module, ModMatrix::_10_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 93.213)), module, ModMatrix::_10_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 93.213)), module, ModMatrix::_10_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 93.213)), module, ModMatrix::_10_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 93.213)), module, ModMatrix::_10_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 93.214)), module, ModMatrix::_10_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 93.214)), module, ModMatrix::_10_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 93.214)), module, ModMatrix::_10_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 93.212)), module, ModMatrix::_10_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 93.214)), module, ModMatrix::_10_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 93.214)), module, ModMatrix::_10_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 93.214)), module, ModMatrix::_10_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 101.503)), module, ModMatrix::_11_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 101.503)), module, ModMatrix::_11_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 101.502)), module, ModMatrix::_11_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 101.503)), module, ModMatrix::_11_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 101.503)), module, ModMatrix::_11_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 101.503)), module, ModMatrix::_11_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 101.503)), module, ModMatrix::_11_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 101.503)), module, ModMatrix::_11_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 101.503)), module, ModMatrix::_11_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 101.504)), module, ModMatrix::_11_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 101.504)), module, ModMatrix::_11_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 101.504)), module, ModMatrix::_11_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 101.503)), module, ModMatrix::_11_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 101.504)), module, ModMatrix::_11_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 101.504)), module, ModMatrix::_11_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 101.504)), module, ModMatrix::_11_16_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(14.692, 109.795)), module, ModMatrix::_12_1_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(22.713, 109.795)), module, ModMatrix::_12_2_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(30.734, 109.794)), module, ModMatrix::_12_3_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(38.755, 109.795)), module, ModMatrix::_12_4_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(47.306, 109.794)), module, ModMatrix::_12_5_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(55.327, 109.794)), module, ModMatrix::_12_6_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(63.348, 109.795)), module, ModMatrix::_12_7_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(71.369, 109.795)), module, ModMatrix::_12_8_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(79.919, 109.795)), module, ModMatrix::_12_9_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(87.94, 109.795)), module, ModMatrix::_12_10_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(95.961, 109.795)), module, ModMatrix::_12_11_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(103.982, 109.795)), module, ModMatrix::_12_12_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(112.533, 109.794)), module, ModMatrix::_12_13_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(120.554, 109.795)), module, ModMatrix::_12_14_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(128.575, 109.795)), module, ModMatrix::_12_15_PARAM));
-		addParam(createParamCentered<Trimpot>(mm2px(Vec(136.596, 109.795)), module, ModMatrix::_12_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 18.601)), module, ModMatrix::_1_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 18.601)), module, ModMatrix::_1_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 18.601)), module, ModMatrix::_1_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 18.601)), module, ModMatrix::_1_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 18.601)), module, ModMatrix::_1_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 18.601)), module, ModMatrix::_1_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 18.601)), module, ModMatrix::_1_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 18.601)), module, ModMatrix::_1_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 18.601)), module, ModMatrix::_1_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 18.601)), module, ModMatrix::_1_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 18.601)), module, ModMatrix::_1_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 18.601)), module, ModMatrix::_1_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 18.6)), module, ModMatrix::_1_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 18.601)), module, ModMatrix::_1_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 18.601)), module, ModMatrix::_1_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 18.601)), module, ModMatrix::_1_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 26.89)), module, ModMatrix::_2_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 26.891)), module, ModMatrix::_2_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 26.89)), module, ModMatrix::_2_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 26.891)), module, ModMatrix::_2_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 26.891)), module, ModMatrix::_2_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 26.891)), module, ModMatrix::_2_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 26.891)), module, ModMatrix::_2_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 26.891)), module, ModMatrix::_2_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 26.891)), module, ModMatrix::_2_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 26.89)), module, ModMatrix::_2_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 26.891)), module, ModMatrix::_2_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 26.891)), module, ModMatrix::_2_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 26.89)), module, ModMatrix::_2_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 26.891)), module, ModMatrix::_2_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 26.891)), module, ModMatrix::_2_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 26.891)), module, ModMatrix::_2_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 35.181)), module, ModMatrix::_3_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 35.182)), module, ModMatrix::_3_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 35.181)), module, ModMatrix::_3_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 35.182)), module, ModMatrix::_3_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 35.182)), module, ModMatrix::_3_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 35.182)), module, ModMatrix::_3_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 35.182)), module, ModMatrix::_3_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 35.182)), module, ModMatrix::_3_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 35.182)), module, ModMatrix::_3_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 35.182)), module, ModMatrix::_3_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 35.182)), module, ModMatrix::_3_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 35.182)), module, ModMatrix::_3_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 35.181)), module, ModMatrix::_3_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 35.182)), module, ModMatrix::_3_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 35.182)), module, ModMatrix::_3_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 35.182)), module, ModMatrix::_3_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 43.471)), module, ModMatrix::_4_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 43.472)), module, ModMatrix::_4_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 43.471)), module, ModMatrix::_4_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 43.472)), module, ModMatrix::_4_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 43.472)), module, ModMatrix::_4_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 43.472)), module, ModMatrix::_4_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 43.472)), module, ModMatrix::_4_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 43.472)), module, ModMatrix::_4_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 43.472)), module, ModMatrix::_4_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 43.472)), module, ModMatrix::_4_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 43.472)), module, ModMatrix::_4_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 43.472)), module, ModMatrix::_4_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 43.471)), module, ModMatrix::_4_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 43.472)), module, ModMatrix::_4_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 43.472)), module, ModMatrix::_4_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 43.472)), module, ModMatrix::_4_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 51.762)), module, ModMatrix::_5_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 51.762)), module, ModMatrix::_5_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 51.761)), module, ModMatrix::_5_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 51.762)), module, ModMatrix::_5_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 51.762)), module, ModMatrix::_5_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 51.762)), module, ModMatrix::_5_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 51.762)), module, ModMatrix::_5_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 51.762)), module, ModMatrix::_5_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 51.762)), module, ModMatrix::_5_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 51.763)), module, ModMatrix::_5_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 51.763)), module, ModMatrix::_5_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 51.763)), module, ModMatrix::_5_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 51.762)), module, ModMatrix::_5_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 51.763)), module, ModMatrix::_5_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 51.763)), module, ModMatrix::_5_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 51.763)), module, ModMatrix::_5_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 60.053)), module, ModMatrix::_6_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 60.053)), module, ModMatrix::_6_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 60.052)), module, ModMatrix::_6_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 60.053)), module, ModMatrix::_6_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 60.053)), module, ModMatrix::_6_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 60.053)), module, ModMatrix::_6_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 60.053)), module, ModMatrix::_6_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 60.053)), module, ModMatrix::_6_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 60.053)), module, ModMatrix::_6_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 60.053)), module, ModMatrix::_6_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 60.053)), module, ModMatrix::_6_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 60.053)), module, ModMatrix::_6_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 60.052)), module, ModMatrix::_6_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 60.053)), module, ModMatrix::_6_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 60.053)), module, ModMatrix::_6_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 60.053)), module, ModMatrix::_6_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 68.342)), module, ModMatrix::_7_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 68.342)), module, ModMatrix::_7_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 68.341)), module, ModMatrix::_7_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 68.342)), module, ModMatrix::_7_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 68.342)), module, ModMatrix::_7_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 68.342)), module, ModMatrix::_7_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 68.342)), module, ModMatrix::_7_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 68.342)), module, ModMatrix::_7_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 68.342)), module, ModMatrix::_7_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 68.343)), module, ModMatrix::_7_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 68.343)), module, ModMatrix::_7_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 68.343)), module, ModMatrix::_7_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 68.342)), module, ModMatrix::_7_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 68.343)), module, ModMatrix::_7_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 68.343)), module, ModMatrix::_7_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 68.343)), module, ModMatrix::_7_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 76.632)), module, ModMatrix::_8_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 76.632)), module, ModMatrix::_8_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 76.631)), module, ModMatrix::_8_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 76.632)), module, ModMatrix::_8_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 76.632)), module, ModMatrix::_8_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 76.632)), module, ModMatrix::_8_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 76.632)), module, ModMatrix::_8_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 76.632)), module, ModMatrix::_8_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 76.632)), module, ModMatrix::_8_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 76.633)), module, ModMatrix::_8_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 76.633)), module, ModMatrix::_8_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 76.633)), module, ModMatrix::_8_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 76.632)), module, ModMatrix::_8_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 76.633)), module, ModMatrix::_8_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 76.633)), module, ModMatrix::_8_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 76.633)), module, ModMatrix::_8_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 84.923)), module, ModMatrix::_9_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 84.923)), module, ModMatrix::_9_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 84.922)), module, ModMatrix::_9_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 84.923)), module, ModMatrix::_9_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 84.923)), module, ModMatrix::_9_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 84.923)), module, ModMatrix::_9_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 84.923)), module, ModMatrix::_9_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 84.923)), module, ModMatrix::_9_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 84.923)), module, ModMatrix::_9_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 84.923)), module, ModMatrix::_9_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 84.923)), module, ModMatrix::_9_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 84.923)), module, ModMatrix::_9_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 84.922)), module, ModMatrix::_9_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 84.923)), module, ModMatrix::_9_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 84.923)), module, ModMatrix::_9_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 84.923)), module, ModMatrix::_9_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 93.212)), module, ModMatrix::_10_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 93.213)), module, ModMatrix::_10_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 93.212)), module, ModMatrix::_10_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 93.213)), module, ModMatrix::_10_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 93.213)), module, ModMatrix::_10_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 93.213)), module, ModMatrix::_10_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 93.213)), module, ModMatrix::_10_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 93.213)), module, ModMatrix::_10_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 93.213)), module, ModMatrix::_10_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 93.214)), module, ModMatrix::_10_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 93.214)), module, ModMatrix::_10_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 93.214)), module, ModMatrix::_10_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 93.212)), module, ModMatrix::_10_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 93.214)), module, ModMatrix::_10_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 93.214)), module, ModMatrix::_10_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 93.214)), module, ModMatrix::_10_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 101.503)), module, ModMatrix::_11_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 101.503)), module, ModMatrix::_11_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 101.502)), module, ModMatrix::_11_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 101.503)), module, ModMatrix::_11_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 101.503)), module, ModMatrix::_11_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 101.503)), module, ModMatrix::_11_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 101.503)), module, ModMatrix::_11_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 101.503)), module, ModMatrix::_11_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 101.503)), module, ModMatrix::_11_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 101.504)), module, ModMatrix::_11_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 101.504)), module, ModMatrix::_11_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 101.504)), module, ModMatrix::_11_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 101.503)), module, ModMatrix::_11_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 101.504)), module, ModMatrix::_11_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 101.504)), module, ModMatrix::_11_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 101.504)), module, ModMatrix::_11_16_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(14.692, 109.795)), module, ModMatrix::_12_1_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(22.713, 109.795)), module, ModMatrix::_12_2_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(30.734, 109.794)), module, ModMatrix::_12_3_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(38.755, 109.795)), module, ModMatrix::_12_4_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(47.306, 109.794)), module, ModMatrix::_12_5_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(55.327, 109.794)), module, ModMatrix::_12_6_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(63.348, 109.795)), module, ModMatrix::_12_7_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(71.369, 109.795)), module, ModMatrix::_12_8_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(79.919, 109.795)), module, ModMatrix::_12_9_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(87.94, 109.795)), module, ModMatrix::_12_10_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(95.961, 109.795)), module, ModMatrix::_12_11_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(103.982, 109.795)), module, ModMatrix::_12_12_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(112.533, 109.794)), module, ModMatrix::_12_13_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(120.554, 109.795)), module, ModMatrix::_12_14_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(128.575, 109.795)), module, ModMatrix::_12_15_PARAM));
+		addParam(createParamCentered<DepthTrimpot>(mm2px(Vec(136.596, 109.795)), module, ModMatrix::_12_16_PARAM));
 
 		addParam(createLightParamCentered<VCVLightLatch<MediumSimpleLight<WhiteLight>>>(mm2px(Vec(144.617,  18.601)), module, ModMatrix::SEL1_PARAM, ModMatrix::SEL1_LIGHT));
 		addParam(createLightParamCentered<VCVLightLatch<MediumSimpleLight<WhiteLight>>>(mm2px(Vec(144.617,  26.891)), module, ModMatrix::SEL2_PARAM, ModMatrix::SEL2_LIGHT));
@@ -886,6 +1907,8 @@ struct ModMatrixWidget : ModuleWidget {
 		addInput(createInputCentered<ThemedPJ301MPort>(mm2px(Vec(6.142, 93.213)), module, ModMatrix::_10_INPUT));
 		addInput(createInputCentered<ThemedPJ301MPort>(mm2px(Vec(6.142, 101.503)), module, ModMatrix::_11_INPUT));
 		addInput(createInputCentered<ThemedPJ301MPort>(mm2px(Vec(6.142, 109.794)), module, ModMatrix::_12_INPUT));
+		addInput(createInputCentered<ThemedPJ301MPort>(mm2px(Vec(152.638, 120.21)), module, ModMatrix::MORPH_INPUT));
+		addInput(createInputCentered<ThemedPJ301MPort>(mm2px(Vec(144.617, 120.21)), module, ModMatrix::DEPTH_INPUT));
 
 		addOutput(createOutputCentered<ThemedPJ301MPort>(mm2px(Vec(14.692, 120.21)), module, ModMatrix::_1_OUTPUT));
 		addOutput(createOutputCentered<ThemedPJ301MPort>(mm2px(Vec(22.713, 120.21)), module, ModMatrix::_2_OUTPUT));
@@ -918,7 +1941,78 @@ struct ModMatrixWidget : ModuleWidget {
 				return log2(module->sampleRateReduction);
 			},
 			[=](int mode) {
-				module->setSampleRateReduction(std::pow(2, mode));
+				module->commands.push(ModMatrix::SET_SAMPLE_RATE_REDUCTION, std::pow(2, mode));
+			}
+		));
+
+		menu->addChild(createIndexSubmenuItem("Block processing", {"Off", "4 samples", "8 samples", "16 samples"},
+			[=]() {
+				return module->blockSize == 1 ? 0 : log2(module->blockSize) - 1;
+			},
+			[=](int mode) {
+				module->commands.push(ModMatrix::SET_BLOCK_SIZE, mode ? 1 << (mode + 1) : 1);
+			}
+		));
+		if (module->blockSize > 1)
+		{
+			if (module->sampleRateReduction == 1)
+			{
+				menu->addChild(createMenuLabel(string::f("Block processing latency: %d samples (%.2f ms)",
+						module->blockSize, 1000.f * module->blockSize / module->sampleRate)));
+			}
+			else
+			{
+				menu->addChild(createMenuLabel("Block processing is off while the sample rate is reduced"));
+			}
+		}
+
+		menu->addChild(createBoolMenuItem("Interpolate outputs", "",
+			[=]() {
+				return module->interpolate;
+			},
+			[=](int mode) {
+				module->commands.push(ModMatrix::SET_INTERPOLATE, mode);
+			}
+		));
+
+		std::vector<std::string> positions = {"Off"};
+		for (int k = 1; k < ModMatrix::maxRowBlocks * ModMatrix::maxColumnBlocks; k++)
+		{
+			int r = k / ModMatrix::maxColumnBlocks;
+			int c = k % ModMatrix::maxColumnBlocks;
+			// only the first column block has signal inputs, and only the first row block has mix outputs
+			positions.push_back("Inputs " + std::to_string(r * ModMatrix::rows + 1) + "-" + std::to_string((r+1) * ModMatrix::rows) +
+					", Mix " + std::to_string(c * ModMatrix::columns + 1) + "-" + std::to_string((c+1) * ModMatrix::columns) +
+					(r && c ? " (knobs only, inputs and outputs unused)" : ""));
+		}
+		menu->addChild(createIndexSubmenuItem("Expander position", positions,
+			[=]() {
+				return module->expanderPosition;
+			},
+			[=](int position) {
+				module->commands.push(ModMatrix::SET_EXPANDER_POSITION, position);
+			}
+		));
+
+		menu->addChild(createSubmenuItem("Scenes", "",
+			[=](Menu* menu) {
+				for (int k = 0; k < ModMatrix::numScenes; k++)
+				{
+					menu->addChild(createMenuItem("Store scene " + std::to_string(k+1), "",
+						[=]() {
+							module->commands.push(ModMatrix::STORE_SCENE, k);
+						}
+					));
+				}
+				menu->addChild(new MenuSeparator);
+				for (int k = 0; k < ModMatrix::numScenes; k++)
+				{
+					menu->addChild(createMenuItem("Recall scene " + std::to_string(k+1), "",
+						[=]() {
+							module->commands.push(ModMatrix::RECALL_SCENE, k);
+						}
+					));
+				}
 			}
 		));
 
@@ -945,15 +2039,7 @@ struct ModMatrixWidget : ModuleWidget {
 				return module->bipolar;
 			},
 			[=](int mode) {
-				module->bipolar = mode;
-				module->setPolarity();
-
-				// redraw
-				event::Change c;
-				for (ParamWidget* param : getParams())
-				{
-					param->onChange(c);
-				}
+				module->commands.push(ModMatrix::SET_BIPOLAR, mode);
 			}
 		));
 
@@ -965,6 +2051,25 @@ struct ModMatrixWidget : ModuleWidget {
 				module->relative = mode;
 			}
 		));
+
+		menu->addChild(new MenuSeparator);
+
+		appendCpuGovernorMenu(menu, &module->governor);
+	}
+
+	void step() override {
+		ModMatrix* module = getModule<ModMatrix>();
+		if (module && module->bipolar != bipolar)
+		{
+			// the polarity is changed by the audio thread, redraw the knobs with the new range
+			bipolar = module->bipolar;
+			event::Change c;
+			for (ParamWidget* param : getParams())
+			{
+				param->onChange(c);
+			}
+		}
+		ModuleWidget::step();
 	}
 
 	void setLatch(ModMatrix* module)
@@ -28,7 +28,9 @@ struct OnePole : Module {
 
 	const float minFreq = 5.f; // min freq [Hz]
 	const float base = 22000.f/minFreq; // max freq/min freq
-	const float logBase = std::log(base);
+	const float log2Base = std::log2(base);
+	const float log2MinFreq = std::log2(minFreq);
+	float log2SampleRate = std::log2(48000.f);
 
 	int channels = 1;
 
@@ -51,22 +53,35 @@ struct OnePole : Module {
 		configBypass(IN_INPUT, OUT_OUTPUT);
 	}
 
+	void onSampleRateChange(const SampleRateChangeEvent& e) override {
+		log2SampleRate = std::log2(e.sampleRate);
+	}
+
 	void process(const ProcessArgs& args) override {
-		if (cvDivider.process())
+		bool cvTick = cvDivider.process();
+		if (cvTick)
 		{
 			channels = std::max(1, inputs[IN_INPUT].getChannels());
 			outputs[OUT_OUTPUT].setChannels(channels);
+		}
+
+		// cutoff CV is applied every sample, the knobs alone every 8 samples
+		bool highpassUpdate = cvTick || inputs[HIGHPASS_INPUT].isConnected();
+		bool lowpassUpdate = cvTick || inputs[LOWPASS_INPUT].isConnected();
 
-			for (int c = 0; c < channels; c += 4) {
+		for (int c = 0; c < channels; c += 4) {
+			if (highpassUpdate)
+			{
 				float_4 voltage = params[HIGHPASS_PARAM].getValue() + 0.1f * inputs[HIGHPASS_INPUT].getPolyVoltageSimd<float_4>(c);
-				float_4 frequency = simd::exp(logBase * voltage) * minFreq;
-				frequency = simd::clamp(frequency, 1.f, args.sampleRate/2.1f);
-				highpass[c/4].setCutoffFreq(frequency / args.sampleRate);
-
-				voltage = params[LOWPASS_PARAM].getValue() + 0.1f * inputs[LOWPASS_INPUT].getPolyVoltageSimd<float_4>(c);
-				frequency = simd::exp(logBase * voltage) * minFreq;
-				frequency = simd::clamp(frequency, 0.f, args.sampleRate/2.f);
-				lowpass[c/4].setCutoffFreq(frequency / args.sampleRate);
+				// at least 1 Hz
+				float_4 log2f = simd::fmax(log2Base * voltage + log2MinFreq, 0.f) - log2SampleRate;
+				highpass[c/4].setCutoffFreqLog2(log2f);
+			}
+
+			if (lowpassUpdate)
+			{
+				float_4 voltage = params[LOWPASS_PARAM].getValue() + 0.1f * inputs[LOWPASS_INPUT].getPolyVoltageSimd<float_4>(c);
+				lowpass[c/4].setCutoffFreqLog2(log2Base * voltage + log2MinFreq - log2SampleRate);
 			}
 		}
 
@@ -26,7 +26,9 @@ struct OnePoleLP : Module {
 
 	const float minFreq = 0.01f; // min freq [Hz]
 	const float base = 22000.f/minFreq; // max freq/min freq
-	const float logBase = std::log(base);
+	const float log2Base = std::log2(base);
+	const float log2MinFreq = std::log2(minFreq);
+	float log2SampleRate = std::log2(48000.f);
 
 	int channels = 1;
 
@@ -46,17 +48,24 @@ struct OnePoleLP : Module {
 		configBypass(IN_INPUT, OUT_OUTPUT);
 	}
 
+	void onSampleRateChange(const SampleRateChangeEvent& e) override {
+		log2SampleRate = std::log2(e.sampleRate);
+	}
+
 	void process(const ProcessArgs& args) override {
-		if (cvDivider.process())
+		bool cvTick = cvDivider.process();
+		if (cvTick)
 		{
 			channels = std::max(1, inputs[IN_INPUT].getChannels());
 			outputs[OUT_OUTPUT].setChannels(channels);
+		}
 
+		// cutoff CV is applied every sample, the knob alone every 8 samples
+		if (cvTick || inputs[LOWPASS_INPUT].isConnected())
+		{
 			for (int c = 0; c < channels; c += 4) {
 				float_4 voltage = params[LOWPASS_PARAM].getValue() + 0.1f * inputs[LOWPASS_INPUT].getPolyVoltageSimd<float_4>(c);
-				float_4 frequency = simd::exp(logBase * voltage) * minFreq;
-				frequency = simd::clamp(frequency, 0.f, args.sampleRate/2.f);
-				lowpass[c/4].setCutoffFreq(frequency / args.sampleRate);
+				lowpass[c/4].setCutoffFreqLog2(log2Base * voltage + log2MinFreq - log2SampleRate);
 			}
 		}
 
@@ -1,7 +1,10 @@
 #include "plugin.hpp"
+#include "dsp/commands.hpp"
 #include "dsp/decimator.hpp"
 #include "dsp/filters.hpp"
 #include "dsp/functions.hpp"
+#include "dsp/governor.hpp"
+#include "dsp/oscillators.hpp"
 
 namespace musx {
 
@@ -21,6 +24,8 @@ struct Oscillators : Module {
 		SYNC_PARAM,
 		FM_PARAM,
 		RINGMOD_PARAM,
+		UNISON_DETUNE_PARAM,
+		UNISON_SPREAD_PARAM,
 		PARAMS_LEN
 	};
 	enum InputId {
@@ -55,33 +60,85 @@ struct Oscillators : Module {
 
 	int sampleRate = 48000;
 	int oversamplingRate = 16;
-	int actualOversamplingRate = 16;
+	int internalSampleRate = 0; // [Hz], sets oversamplingRate according to the sample rate; 0: fixed oversamplingRate
 
-	HalfBandDecimatorCascade<float_4> decimator[4];
+	int decimationQuality = 1;
+
+	static const int maxUnison = 8;
+	int unison = 1; // copies of the oscillators per voice, in the SIMD lanes
 
 	int channels = 1;
 
-	// integers overflow, so phase resets automatically
-	int32_4 phasor1Sub[4] = {0};
-	int32_4 phasor2[4] = {0};
+	// CV modulated parameters of a group of voices, or of a group of unison copies
+	typedef OscillatorParameters Parameters;
+
+	static const int latencyBufferLength = 64; // power of 2, longer than the latency of all paths
+
+	/**
+	 * Oscillators, DC blocker, saturator and decimator at one oversampling rate.
+	 * When the rate, the decimation quality, the LFO mode or the unison changes, the other path takes over, and the two are crossfaded.
+	 */
+	struct Path {
+		int oversamplingRate = 16;
+		bool lfoMode = false;
+		int decimationQuality = 1;
+		int unison = 1;
+
+		// unison: copy i of voice v is in lane v * unison + i
+		Parameters lanes[4];
+		float_4 laneDetune[4] = {0}; // [V]
+		float_4 laneGain[4] = {0};
+		float_4 laneBuffer[4][maxOversamplingRate];
+
+		// lane group g holds copies of the voices laneFirstVoice[g] and laneLastVoice[g] only, see setLaneParameters
+		int laneFirstVoice[4] = {0};
+		int laneLastVoice[4] = {0};
+		float_4 laneIsFirst[4] = {0}; // mask of the copies of laneFirstVoice
+		float_4 laneMix[4][4] = {}; // [lane group][lane], gain of the copy in the lane of its voice, 0 for unused lanes
+
+		// integers overflow, so phase resets automatically
+		int32_4 phasor1Sub[4] = {0};
+		int32_4 phasor2[4] = {0};
+		float_4 mixDelay[4] = {0};
+
+		MultiQualityDecimatorCascade<float_4> decimator[4];
+		musx::TOnePole<float_4> dcBlocker[4];
+		musx::CheapSaturatorADAA1 saturator[4];
+
+		// the output is delayed to the common latency of all paths, see setLatencyDelay
+		float_4 latencyBuffer[4][latencyBufferLength] = {};
+		int latencyIndex = 0;
+		int latencyDelay = 0; // [samples]
+	};
 
-	float_4 mix[4][maxOversamplingRate] = {0};
+	Path paths[2];
+	int activePath = 0;
 
-	// CV modulated parameters
-	float_4 osc1Shape[4] = {0};
-	float_4 osc1PW[4] = {0};
-	float_4 osc1Vol[4] = {0};
-	float_4 osc1Subvol[4] = {0};
+	static const int fadeLength = 512; // [samples]
+	static const int fadeDelay = 64; // [samples], the decimators and the latency delay of the new path start from silence
+	int fadeCounter = 0;
 
-	float_4 osc2Shape[4] = {0};
-	float_4 osc2PW[4] = {0};
-	float_4 osc2Vol[4] = {0};
+	Parameters voices[4];
 
-	float_4 fm[4] = {0};
-	float_4 ringmod[4] = {0};
+	// parameters with disconnected CV inputs are only updated at this rate
+	dsp::ClockDivider controlDivider;
+	int prevChannels = 0;
 
 	bool dcBlock = true;
-	musx::TOnePole<float_4> dcBlocker[4];
+
+	// reduces the oversampling rate when the CPU budget is exceeded
+	musx::CpuGovernor governor;
+
+	// settings from the context menu, applied in process()
+	enum CommandId {
+		SET_OVERSAMPLING_RATE,
+		SET_INTERNAL_SAMPLE_RATE,
+		SET_DECIMATION_QUALITY,
+		SET_DC_BLOCK,
+		SET_LFO_MODE,
+		SET_UNISON
+	};
+	musx::CommandQueue<> commands;
 
 	dsp::ClockDivider lightDivider;
 
@@ -97,6 +154,11 @@ struct Oscillators : Module {
 		configSwitch(SYNC_PARAM, 		  0,   1,   0,  "Sync", {"Off", "Sync osc 2 to osc 1"});
 		configParam(FM_PARAM, 	  		0.f, 1.f, 0.f, 	"Osc 1 to osc 2 FM amount", " %", 0.f, 100.f);
 		configParam(RINGMOD_PARAM, 		0.f, 1.f, 0.f, 	"Ring modulator volume", 	" %", 0.f, 100.f);
+		// no panel controls, set in the context menu
+		configParam(UNISON_DETUNE_PARAM, 0.f, 100.f, 20.f, "Unison detune", " cents");
+		configParam(UNISON_SPREAD_PARAM, 0.f, 1.f, 1.f, "Unison spread", " %", 0.f, 100.f);
+		getParamQuantity(UNISON_DETUNE_PARAM)->randomizeEnabled = false;
+		getParamQuantity(UNISON_SPREAD_PARAM)->randomizeEnabled = false;
 		configInput(OSC1SHAPE_INPUT, 	"Oscillator 1 shape CV");
 		configInput(OSC1PW_INPUT, 		"Oscillator 1 pulse width CV");
 		configInput(OSC1VOL_INPUT, 		"Oscillator 1 volume CV");
@@ -109,155 +171,524 @@ struct Oscillators : Module {
 		configInput(RINGMOD_INPUT, 		"Ring modulator volume CV");
 		configInput(OSC1VOCT_INPUT, 	"Oscillator 1 V/Oct");
 		configInput(OSC2VOCT_INPUT, 	"Oscillator 2 V/Oct");
-		configOutput(OUT_OUTPUT, 		"Mix");
+		CpuGovernorPortInfo* outInfo = configOutput<CpuGovernorPortInfo>(OUT_OUTPUT, "Mix");
+		outInfo->governor = &governor;
+		outInfo->getSetting = [=]() {
+			return string::f("%dx oversampling", getGovernedOversamplingRate());
+		};
 
+		controlDivider.setDivision(16);
 		lightDivider.setDivision(512);
+
+		setLatencyDelay(paths[0]);
+		setLatencyDelay(paths[1]);
 	}
 
 	void onSampleRateChange(const SampleRateChangeEvent& e) override {
 		sampleRate = e.sampleRate;
-		setOversamplingRate(oversamplingRate);
+
+		for (Path& path : paths)
+		{
+			for (int c = 0; c < 16; c += 4) {
+				// the decimators keep a 21 kHz pass band, independent of the sample rate
+				path.decimator[c/4].setPassBand(21000. / sampleRate);
+				path.dcBlocker[c/4].setCutoffFreq(20.f/sampleRate/path.oversamplingRate);
+			}
+		}
+
+		setInternalSampleRate(internalSampleRate);
 	}
 
+	void setInternalSampleRate(int arg)
+	{
+		internalSampleRate = arg;
+		if (internalSampleRate > 0)
+		{
+			setOversamplingRate(oversamplingRateFor(internalSampleRate, sampleRate, maxOversamplingRate));
+		}
+		else
+		{
+			setOversamplingRate(oversamplingRate);
+		}
+	}
+
+	/**
+	 * the new rate is applied at the next sample, see startFade()
+	 */
 	void setOversamplingRate(int arg)
 	{
-		oversamplingRate = arg;
+		oversamplingRate = clamp(arg, 1, maxOversamplingRate);
+		governor.maxLevel = std::log2(oversamplingRate);
+	}
+
+	/** oversampling rate after the reduction by the CPU governor */
+	int getGovernedOversamplingRate()
+	{
+		return std::max(1, oversamplingRate >> governor.level);
+	}
+
+	/**
+	 * the new quality is applied at the next sample, see startFade()
+	 */
+	void setDecimationQuality(int arg)
+	{
+		decimationQuality = clamp(arg, 0, 2);
+	}
+
+	void applyCommand(const musx::Command& command)
+	{
+		switch (command.id)
+		{
+			case SET_OVERSAMPLING_RATE:
+				internalSampleRate = 0;
+				setOversamplingRate(command.value);
+				break;
+			case SET_INTERNAL_SAMPLE_RATE:
+				setInternalSampleRate(command.value);
+				break;
+			case SET_DECIMATION_QUALITY:
+				setDecimationQuality(command.value);
+				break;
+			case SET_DC_BLOCK:
+				dcBlock = command.value;
+				break;
+			case SET_LFO_MODE:
+				lfoMode = command.value;
+				break;
+			case SET_UNISON:
+				unison = clamp(command.value, 1, maxUnison);
+				break;
+		}
+	}
+
+	/**
+	 * The decimators of the tiers and rates have different latencies. All paths are delayed to the latency of the slowest
+	 * one, the Mastering tier at the maximum rate, so the two paths are aligned to the sample in the crossfade, and
+	 * the latency of the output does not change. About 37 samples, the decimators alone have up to 36.9.
+	 */
+	void setLatencyDelay(Path& path)
+	{
+		static const float outputLatency = std::ceil(halfBandCascadeLatency<HalfBandQualityMastering>(maxOversamplingRate) + 0.5f / maxOversamplingRate);
+
+		float latency = 0.f;
+		if (!path.lfoMode)
+		{
+			// decimator plus half a sample of the anti-aliased saturator
+			latency = path.decimator[0].getLatency(path.oversamplingRate) + 0.5f / path.oversamplingRate;
+		}
+		path.latencyDelay = clamp((int)std::round(outputLatency - latency), 0, latencyBufferLength - 1);
+	}
+
+	/**
+	 * The inactive path takes over with the current settings, at the phase of the active path.
+	 * Only preallocated state is reset, and the old path keeps running until the crossfade is done.
+	 */
+	void startFade(int rate)
+	{
+		Path& from = paths[activePath];
+		Path& to = paths[1 - activePath];
+
+		to.oversamplingRate = rate;
+		to.lfoMode = lfoMode;
+		to.decimationQuality = decimationQuality;
+		to.unison = unison;
+		setUnisonDetune(to);
+		setLaneParameters(to);
 
-		// reset phasors and mix
 		for (int c = 0; c < 16; c += 4) {
-			phasor1Sub[c/4] = 0.f;
-			phasor2[c/4] = 0.f;
+			if (to.unison == from.unison)
+			{
+				to.phasor1Sub[c/4] = from.phasor1Sub[c/4];
+				to.phasor2[c/4] = from.phasor2[c/4];
+				to.mixDelay[c/4] = from.mixDelay[c/4];
+			}
+			else
+			{
+				// the copies of a voice start at different phases
+				for (int i = 0; i < 4; i++)
+				{
+					uint32_t phase = (c + i) % to.unison * 2654435769u;
+					to.phasor1Sub[c/4][i] = phase;
+					to.phasor2[c/4][i] = phase;
+				}
+				to.mixDelay[c/4] = 0.f;
+			}
+
+			// only the past samples the stages of the new rate read are cleared, the other stages are not used
+			to.decimator[c/4].setQuality(decimationQuality);
+			to.decimator[c/4].clearHistory(lfoMode ? 1 : rate);
+			to.saturator[c/4].reset();
+
+			// keep the DC estimate
+			to.dcBlocker[c/4] = from.dcBlocker[c/4];
+			to.dcBlocker[c/4].setCutoffFreq(20.f/sampleRate/rate);
+		}
+
+		setLatencyDelay(to);
+
+		activePath = 1 - activePath;
+		fadeCounter = fadeLength;
+	}
 
-			for (int i = 0; i < maxOversamplingRate; ++i)
+	/**
+	 * Detune and gain of the unison copies.
+	 * The outermost copies are detuned by +-'Unison detune', spread sets the volume of the outer copies relative to the inner ones.
+	 */
+	void setUnisonDetune(Path& path)
+	{
+		float detune = params[UNISON_DETUNE_PARAM].getValue() / 1200.f; // [V]
+		float spread = params[UNISON_SPREAD_PARAM].getValue();
+
+		int n = path.unison;
+		float position[maxUnison];
+		float weight[maxUnison];
+		float sum = 0.f;
+		for (int i = 0; i < n; i++)
+		{
+			position[i] = n > 1 ? (2.f * i + 1.f - n) / (n - 1) : 0.f; // -1..1
+			weight[i] = 1.f - (1.f - spread) * std::fabs(position[i]) * (n - 1) / n;
+			sum += weight[i] * weight[i];
+		}
+
+		// same loudness for uncorrelated copies
+		float gain = 1.f / std::sqrt(sum);
+
+		for (int lane = 0; lane < 16; lane++)
+		{
+			path.laneDetune[lane/4][lane%4] = detune * position[lane % n];
+			path.laneGain[lane/4][lane%4] = gain * weight[lane % n];
+		}
+	}
+
+	/**
+	 * Parameters of the voice of each unison copy, and the mix of the copies into their voices.
+	 * Changes at control rate or with connected CV inputs, the pitch is set per sample by setLanePitch.
+	 */
+	void setLaneParameters(Path& path)
+	{
+		int n = path.unison;
+		// channels are limited to the new unison after a fade starts
+		int usedLanes = std::min(channels * n, 16);
+		for (int lane = 0; lane < usedLanes; lane++)
+		{
+			const Parameters& from = voices[lane / n / 4];
+			Parameters& to = path.lanes[lane/4];
+			int i = lane / n % 4;
+			int j = lane % 4;
+
+			to.osc1Shape[j] = from.osc1Shape[i];
+			to.osc1PW[j] = from.osc1PW[i];
+			to.osc1Vol[j] = from.osc1Vol[i];
+			to.osc1Subvol[j] = from.osc1Subvol[i];
+			to.osc2Shape[j] = from.osc2Shape[i];
+			to.osc2PW[j] = from.osc2PW[i];
+			to.osc2Vol[j] = from.osc2Vol[i];
+			to.fm[j] = from.fm[i];
+			to.ringmod[j] = from.ringmod[i];
+			to.sync[j] = from.sync[i];
+		}
+
+		// with at least 2 copies per voice, the 4 lanes of a group hold copies of at most 2 adjacent voices
+		for (int g = 0; g < 4; g++)
+		{
+			path.laneFirstVoice[g] = 4 * g / n;
+			path.laneLastVoice[g] = (4 * g + 3) / n;
+			float_4 voice(4 * g / n, (4 * g + 1) / n, (4 * g + 2) / n, (4 * g + 3) / n);
+			path.laneIsFirst[g] = voice == float_4(path.laneFirstVoice[g]);
+
+			for (int j = 0; j < 4; j++)
 			{
-				mix[c/4][i] = 0.f;
+				int lane = 4 * g + j;
+				path.laneMix[g][j] = 0.f;
+				if (lane < usedLanes)
+				{
+					path.laneMix[g][j][lane / n % 4] = path.laneGain[g][j];
+				}
 			}
+		}
+	}
 
-			decimator[c/4].reset();
-			dcBlocker[c/4].setCutoffFreq(20.f/sampleRate/oversamplingRate);
+	/**
+	 * pitch of the unison copies plus detune, the voice pitch is broadcast to the lanes of its copies
+	 */
+	void setLanePitch(Path& path)
+	{
+		for (int c = 0; c < channels * path.unison; c += 4)
+		{
+			int first = path.laneFirstVoice[c/4];
+			int last = path.laneLastVoice[c/4];
+			Parameters& to = path.lanes[c/4];
+			to.voct1 = simd::ifelse(path.laneIsFirst[c/4], float_4(voices[first/4].voct1[first%4]), float_4(voices[last/4].voct1[last%4])) + path.laneDetune[c/4];
+			to.voct2 = simd::ifelse(path.laneIsFirst[c/4], float_4(voices[first/4].voct2[first%4]), float_4(voices[last/4].voct2[last%4])) + path.laneDetune[c/4];
 		}
 	}
 
-	void process(const ProcessArgs& args) override {
-		channels = std::max(1, inputs[OSC1VOCT_INPUT].getChannels());
-		channels = std::max(channels, inputs[OSC2VOCT_INPUT].getChannels());
-		outputs[OUT_OUTPUT].setChannels(channels);
+	/**
+	 * parameter plus scaled CV, clamped
+	 */
+	float_4 modulatedParam(int paramId, int inputId, float scale, float min, float max, int c)
+	{
+		return simd::clamp(params[paramId].getValue() + scale * inputs[inputId].getPolyVoltageSimd<float_4>(c), min, max);
+	}
 
-		for (int c = 0; c < channels; c += 4) {
-			// parameters and CVs
-			osc1Shape[c/4] 	= simd::clamp(params[OSC1SHAPE_PARAM].getValue() + 0.2f *inputs[OSC1SHAPE_INPUT].getPolyVoltageSimd<float_4>(c), -1.f, 1.f);
-			osc1PW[c/4] 	= simd::clamp(params[OSC1PW_PARAM].getValue() 	 + 0.2f *inputs[OSC1PW_INPUT].getPolyVoltageSimd<float_4>(c),    -1.f, 1.f);
-			osc1Vol[c/4] 	= simd::clamp(params[OSC1VOL_PARAM].getValue()   + 0.1f *inputs[OSC1VOL_INPUT].getPolyVoltageSimd<float_4>(c),    0.f, 1.f);
-			osc1Vol[c/4]   *= 10.f / INT32_MAX;
-			osc1Subvol[c/4] = simd::clamp(params[OSC1SUBVOL_PARAM].getValue() + 0.1f *inputs[OSC1SUBVOL_INPUT].getPolyVoltageSimd<float_4>(c), 0.f, 1.f);
-			osc1Subvol[c/4]   *= 10.f / INT32_MAX;
-
-			osc2Shape[c/4] 	= simd::clamp(params[OSC2SHAPE_PARAM].getValue() + 0.2f *inputs[OSC2SHAPE_INPUT].getPolyVoltageSimd<float_4>(c), -1.f, 1.f);
-			osc2PW[c/4] 	= simd::clamp(params[OSC2PW_PARAM].getValue() 	 + 0.2f *inputs[OSC2PW_INPUT].getPolyVoltageSimd<float_4>(c),    -1.f, 1.f);
-			osc2Vol[c/4] 	= simd::clamp(params[OSC2VOL_PARAM].getValue()   + 0.1f *inputs[OSC2VOL_INPUT].getPolyVoltageSimd<float_4>(c),    0.f, 1.f);
-			osc2Vol[c/4]   *= 10.f / INT32_MAX;
-
-			fm[c/4] 		= simd::clamp(params[FM_INPUT].getValue()  + 0.1f *inputs[FM_INPUT].getPolyVoltageSimd<float_4>(c),  0.f, 1.f);
-			fm[c/4] 		= fm[c/4] * fm[c/4] * 0.5f / oversamplingRate; // scale
-			ringmod[c/4]  	= simd::clamp(params[RINGMOD_PARAM].getValue() + 0.1f *inputs[RINGMOD_INPUT].getPolyVoltageSimd<float_4>(c), 0.f, 1.f);
-			ringmod[c/4]   *= 10.f / INT32_MAX / INT32_MAX;
-
-			int32_4 sync = simd::round(clamp(params[SYNC_PARAM].getValue() + inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c) / 5.f, 0.f, 1.f));
-
-			// frequencies, phase increments, factors etc
-			float_4 freq1 = dsp::FREQ_C4 * dsp::exp2_taylor5(inputs[OSC1VOCT_INPUT].getVoltageSimd<float_4>(c));
-			float_4 freq2 = dsp::FREQ_C4 * dsp::exp2_taylor5(inputs[OSC2VOCT_INPUT].getPolyVoltageSimd<float_4>(c));
-
-			actualOversamplingRate = oversamplingRate;
-			if (lfoMode)
+	typedef void (*OscillatorsLoop)(const Parameters&, int32_4&, int32_4&, float_4&, int32_4, int32_4, float_4, float_4*, int);
+
+	/**
+	 * oscillators, mix, DC blocker and saturator at the oversampled rate of the path, writes the downsampled output of all voices to out.
+	 * The lane parameters of the unison copies are rebuilt if parametersChanged.
+	 */
+	void processPath(Path& path, float sampleRate, float_4* out, bool parametersChanged)
+	{
+		int actualOversamplingRate = path.lfoMode ? 1 : path.oversamplingRate;
+
+		if (path.unison > 1)
+		{
+			if (parametersChanged)
+			{
+				setLaneParameters(path);
+			}
+			setLanePitch(path);
+		}
+
+		// the sync, FM and ring modulator terms are left out of the loop if they are off for all channels of the group
+		static const OscillatorsLoop loops[8] = {
+			&processOscillators<false, false, false>,
+			&processOscillators<false, false, true>,
+			&processOscillators<false, true, false>,
+			&processOscillators<false, true, true>,
+			&processOscillators<true, false, false>,
+			&processOscillators<true, false, true>,
+			&processOscillators<true, true, false>,
+			&processOscillators<true, true, true>
+		};
+
+		// oscillators, the unison copies of a voice are in adjacent lanes
+		for (int c = 0; c < channels * path.unison; c += 4) {
+			const Parameters& p = path.unison > 1 ? path.lanes[c/4] : voices[c/4];
+
+			float_4 freq1 = dsp::FREQ_C4 * dsp::exp2_taylor5(p.voct1);
+			float_4 freq2 = dsp::FREQ_C4 * dsp::exp2_taylor5(p.voct2);
+			if (path.lfoMode)
 			{
 				// bring frequency down to 2 Hz @ 0V CV/Oct input
 				freq1 *= 2. / dsp::FREQ_C4;
 				freq2 *= 2. / dsp::FREQ_C4;
-
-				actualOversamplingRate = 1;
 			}
 
 			freq1 = simd::clamp(freq1, minFreq, maxFreq);
 			freq2 = simd::clamp(freq2, minFreq, maxFreq);
 
+			float_4 fmAmt = p.fm / path.oversamplingRate;
 
-			int32_4 phase1SubInc = INT32_MAX / args.sampleRate * freq1 / actualOversamplingRate;
-			int32_4 phase1Inc = phase1SubInc + phase1SubInc;
-			float_4 tri1Amt = 2.f * simd::fmax(-osc1Shape[c/4], 0.f);  // [2, 0, 0]
-			float_4 sawSq1Amt = simd::fmin(1.f + osc1Shape[c/4], 1.f); // [0, 1, 1]
-			float_4 sq1Amt = simd::fmax(osc1Shape[c/4], 0.f);          // [0, 0, 1]
-			int32_4 phase1Offset = simd::ifelse(osc1PW[c/4] < 0, (-1.f - osc1PW[c/4]) * INT32_MAX, (1.f - osc1PW[c/4]) * INT32_MAX); // for pulse wave = saw + inverted saw with phaseshift
+			int32_4 phase1SubInc = INT32_MAX / sampleRate * freq1 / actualOversamplingRate;
+			int32_4 phase2Inc = INT32_MAX / sampleRate * freq2 / actualOversamplingRate * 2;
 
-			int32_4 phase2Inc = INT32_MAX / args.sampleRate * freq2 / actualOversamplingRate * 2;
-			float_4 tri2Amt = 2.f * simd::fmax(-osc2Shape[c/4], 0.f);
-			float_4 sawSq2Amt = simd::fmin(1.f + osc2Shape[c/4], 1.f);
-			float_4 sq2Amt = simd::fmax(osc2Shape[c/4], 0.f);
-			int32_4 phase2Offset = simd::ifelse(osc2PW[c/4] < 0, (-1.f - osc2PW[c/4]) * INT32_MAX, (1.f - osc2PW[c/4]) * INT32_MAX); // for pulse wave
+			// without unison, the oscillators write straight to the decimator
+			float_4* inBuffer = path.unison > 1 ? path.laneBuffer[c/4] : path.decimator[c/4].getInputArray(actualOversamplingRate);
 
-			// calculate the oversampled oscillators and mix
-			float_4* inBuffer = decimator[c/4].getInputArray(actualOversamplingRate);
+			int loop = 4 * (simd::movemask(p.sync > 0) != 0) + 2 * (simd::movemask(fmAmt > 0.f) != 0) + (simd::movemask(p.ringmod > 0.f) != 0);
+			loops[loop](p, path.phasor1Sub[c/4], path.phasor2[c/4], path.mixDelay[c/4], phase1SubInc, phase2Inc, fmAmt, inBuffer, actualOversamplingRate);
+		}
+
+		bool calcDcBlock = dcBlock && !path.lfoMode;
 
-			bool calcDcBlock = dcBlock && !lfoMode;
+		for (int c = 0; c < channels; c += 4) {
+			float_4* inBuffer = path.decimator[c/4].getInputArray(actualOversamplingRate);
 
-			for (int i = 0; i < actualOversamplingRate; ++i)
+			// weighted sum of the unison copies, so the decimator runs once per voice: each lane is broadcast and added to the lane of its voice
+			if (path.unison > 1)
 			{
-				// phasors for subosc 1 and osc 1
-				phasor1Sub[c/4] += phase1SubInc;
-				int32_4 phasor1 = phasor1Sub[c/4] + phasor1Sub[c/4];
-				int32_4 phasor1Offset = phasor1 + phase1Offset;
+				int firstGroup = c * path.unison / 4;
+				int endGroup = (std::min(c + 4, channels) * path.unison + 3) / 4;
+				for (int i = 0; i < actualOversamplingRate; ++i)
+				{
+					float_4 sum = 0.f;
+					for (int g = firstGroup; g < endGroup; g++)
+					{
+						__m128 x = path.laneBuffer[g][i].v;
+						sum += float_4(_mm_shuffle_ps(x, x, _MM_SHUFFLE(0, 0, 0, 0))) * path.laneMix[g][0];
+						sum += float_4(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1))) * path.laneMix[g][1];
+						sum += float_4(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 2, 2))) * path.laneMix[g][2];
+						sum += float_4(_mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3))) * path.laneMix[g][3];
+					}
+					inBuffer[i] = sum;
+				}
+			}
 
-				// osc 1 waveform
-				float_4 wave1 = tri1Amt * ((1.f*phasor1Offset + (phasor1Offset > 0) * 2.f * phasor1Offset) + INT32_MAX/2); // +-INT32_MAX
-				wave1 += sawSq1Amt * (phasor1Offset * sq1Amt - 1.f * phasor1); // +-INT32_MAX
+			// DC blocker
+			if (calcDcBlock)
+			{
+				path.dcBlocker[c/4].processBlockHighpass(inBuffer, inBuffer, actualOversamplingRate);
+			}
 
-				// osc 1 suboscillator
-				float_4 sub1 = 1.f * (phasor1Sub[c/4] + INT32_MAX) - 1.f * phasor1Sub[c/4]; // +-INT32_MAX
+			// saturator +-10V
+			if (path.lfoMode)
+			{
+				for (int i = 0; i < actualOversamplingRate; ++i)
+				{
+					inBuffer[i] = musx::cheapSaturator(inBuffer[i]);
+				}
+			}
+			else
+			{
+				// anti-aliased, adds half a sample latency at the oversampled rate
+				for (int i = 0; i < actualOversamplingRate; ++i)
+				{
+					inBuffer[i] = path.saturator[c/4].process(inBuffer[i]);
+				}
+			}
 
-				// phasor for osc 2
-				phasor2[c/4] += phase2Inc + int32_4(fm[c/4] * wave1);
+			// downsampling
+			out[c/4] = path.decimator[c/4].process(actualOversamplingRate);
 
-				// sync / reset phasor2 ?
-				phasor2[c/4] -= (sync & (phasor1 + phase1Inc < phasor1)) * (phasor2[c/4] + INT32_MAX);
-				int32_4 phasor2Offset = phasor2[c/4] + phase2Offset;
+			// the samples before the first ones of a new path are stale, they are within the fade delay
+			path.latencyBuffer[c/4][path.latencyIndex] = out[c/4];
+			out[c/4] = path.latencyBuffer[c/4][(path.latencyIndex - path.latencyDelay) & (latencyBufferLength - 1)];
+		}
+		path.latencyIndex = (path.latencyIndex + 1) & (latencyBufferLength - 1);
+	}
 
-				// osc 2 waveform
-				float_4 wave2 = tri2Amt * ((1.f*phasor2Offset + (phasor2Offset > 0) * 2.f * phasor2Offset) + INT32_MAX/2); // +-INT32_MAX
-				wave2 += sawSq2Amt * (phasor2Offset * sq2Amt - 1.f * phasor2[c/4]); // +-INT32_MAX
+	void process(const ProcessArgs& args) override {
+		governor.begin();
 
-				// mix
-				float_4 out = osc1Subvol[c/4] * sub1 + osc1Vol[c/4] * wave1 + osc2Vol[c/4] * wave2 + ringmod[c/4] * wave1 * wave2; // +-5V each
+		musx::Command command;
+		while (commands.pop(command))
+		{
+			applyCommand(command);
+		}
 
-				// DC blocker
-				if (calcDcBlock)
-				{
-					dcBlocker[c/4].process(out);
-					out = dcBlocker[c/4].highpass();
-				}
+		// changes of the rate, the decimation quality or the LFO mode are applied at this sample boundary, and crossfaded
+		int governedOversamplingRate = getGovernedOversamplingRate();
+		Path& active = paths[activePath];
+		if (fadeCounter == 0 && (active.oversamplingRate != governedOversamplingRate || active.lfoMode != lfoMode || active.decimationQuality != decimationQuality
+				|| active.unison != unison))
+		{
+			startFade(governedOversamplingRate);
+		}
+
+		// the unison copies of all voices must fit into 16 lanes
+		int pathUnison = paths[activePath].unison;
+		if (fadeCounter > 0)
+		{
+			pathUnison = std::max(pathUnison, paths[1 - activePath].unison);
+		}
+
+		channels = std::max(1, inputs[OSC1VOCT_INPUT].getChannels());
+		channels = std::max(channels, inputs[OSC2VOCT_INPUT].getChannels());
+		channels = std::min(channels, 16 / pathUnison);
+		outputs[OUT_OUTPUT].setChannels(channels);
+
+		bool control = controlDivider.process() || channels != prevChannels;
+		prevChannels = channels;
 
-				// saturator +-10V
-				out = musx::cheapSaturator(out);
+		if (control)
+		{
+			setUnisonDetune(paths[0]);
+			setUnisonDetune(paths[1]);
+		}
 
-				inBuffer[i] = out;
+		for (int c = 0; c < channels; c += 4) {
+			Parameters& p = voices[c/4];
+
+			// parameters and CVs, parameters with disconnected CV inputs at control rate
+			if (control || inputs[OSC1SHAPE_INPUT].isConnected())
+			{
+				p.osc1Shape = modulatedParam(OSC1SHAPE_PARAM, OSC1SHAPE_INPUT, 0.2f, -1.f, 1.f, c);
+			}
+			if (control || inputs[OSC1PW_INPUT].isConnected())
+			{
+				p.osc1PW = modulatedParam(OSC1PW_PARAM, OSC1PW_INPUT, 0.2f, -1.f, 1.f, c);
+			}
+			if (control || inputs[OSC1VOL_INPUT].isConnected())
+			{
+				p.osc1Vol = modulatedParam(OSC1VOL_PARAM, OSC1VOL_INPUT, 0.1f, 0.f, 1.f, c) * (10.f / INT32_MAX);
+			}
+			if (control || inputs[OSC1SUBVOL_INPUT].isConnected())
+			{
+				p.osc1Subvol = modulatedParam(OSC1SUBVOL_PARAM, OSC1SUBVOL_INPUT, 0.1f, 0.f, 1.f, c) * (10.f / INT32_MAX);
 			}
 
-			// downsampling
-			float_4 out = decimator[c/4].process(actualOversamplingRate);
+			if (control || inputs[OSC2SHAPE_INPUT].isConnected())
+			{
+				p.osc2Shape = modulatedParam(OSC2SHAPE_PARAM, OSC2SHAPE_INPUT, 0.2f, -1.f, 1.f, c);
+			}
+			if (control || inputs[OSC2PW_INPUT].isConnected())
+			{
+				p.osc2PW = modulatedParam(OSC2PW_PARAM, OSC2PW_INPUT, 0.2f, -1.f, 1.f, c);
+			}
+			if (control || inputs[OSC2VOL_INPUT].isConnected())
+			{
+				p.osc2Vol = modulatedParam(OSC2VOL_PARAM, OSC2VOL_INPUT, 0.1f, 0.f, 1.f, c) * (10.f / INT32_MAX);
+			}
+
+			if (control || inputs[FM_INPUT].isConnected())
+			{
+				p.fm = modulatedParam(FM_PARAM, FM_INPUT, 0.1f, 0.f, 1.f, c);
+				p.fm = p.fm * p.fm * 0.5f; // scale, divided by the oversampling rate in processPath()
+			}
+			if (control || inputs[RINGMOD_INPUT].isConnected())
+			{
+				p.ringmod = modulatedParam(RINGMOD_PARAM, RINGMOD_INPUT, 0.1f, 0.f, 1.f, c) * (10.f / INT32_MAX / INT32_MAX);
+			}
+
+			if (control || inputs[SYNC_INPUT].isConnected())
+			{
+				p.sync = simd::round(modulatedParam(SYNC_PARAM, SYNC_INPUT, 0.2f, 0.f, 1.f, c));
+			}
+
+			// pitch
+			p.voct1 = inputs[OSC1VOCT_INPUT].getVoltageSimd<float_4>(c);
+			p.voct2 = inputs[OSC2VOCT_INPUT].getPolyVoltageSimd<float_4>(c);
+		}
+
+		// the lane parameters of the unison copies only change with the voice parameters
+		bool parametersChanged = control;
+		for (int i = OSC1SHAPE_INPUT; i <= RINGMOD_INPUT; i++)
+		{
+			parametersChanged |= inputs[i].isConnected();
+		}
 
-			outputs[OUT_OUTPUT].setVoltageSimd(out, c);
+		float_4 out[4];
+		processPath(paths[activePath], args.sampleRate, out, parametersChanged);
+
+		// crossfade from the previous path, linear after the decimators of the new path have settled
+		if (fadeCounter > 0)
+		{
+			float_4 previousOut[4];
+			processPath(paths[1 - activePath], args.sampleRate, previousOut, parametersChanged);
+			float fade = clamp(1.f * (fadeLength - fadeCounter - fadeDelay) / (fadeLength - fadeDelay), 0.f, 1.f);
+			for (int c = 0; c < channels; c += 4) {
+				out[c/4] = previousOut[c/4] + fade * (out[c/4] - previousOut[c/4]);
+			}
+		}
+
+		for (int c = 0; c < channels; c += 4) {
+			outputs[OUT_OUTPUT].setVoltageSimd(out[c/4], c);
+		}
+
+		if (fadeCounter > 0)
+		{
+			--fadeCounter;
 		}
 
 		// Light
 		if (lightDivider.process()) {
 			lights[SYNC_LIGHT].setBrightness(params[SYNC_PARAM].getValue());
 		}
+
+		governor.end(args.sampleTime);
 	}
 
 	json_t* dataToJson() override {
 		json_t* rootJ = json_object();
 		json_object_set_new(rootJ, "oversamplingRate", json_integer(oversamplingRate));
+		json_object_set_new(rootJ, "internalSampleRate", json_integer(internalSampleRate));
+		json_object_set_new(rootJ, "decimationQuality", json_integer(decimationQuality));
 		json_object_set_new(rootJ, "dcBlock", json_boolean(dcBlock));
 		json_object_set_new(rootJ, "lfoMode", json_boolean(lfoMode));
+		json_object_set_new(rootJ, "unison", json_integer(unison));
+		json_object_set_new(rootJ, "cpuGovernor", json_boolean(governor.enabled));
+		json_object_set_new(rootJ, "cpuGovernorBudget", json_real(governor.budget));
 		return rootJ;
 	}
 
@@ -267,6 +698,16 @@ struct Oscillators : Module {
 		{
 			setOversamplingRate(json_integer_value(oversamplingRateJ));
 		}
+		json_t* internalSampleRateJ = json_object_get(rootJ, "internalSampleRate");
+		if (internalSampleRateJ)
+		{
+			setInternalSampleRate(json_integer_value(internalSampleRateJ));
+		}
+		json_t* decimationQualityJ = json_object_get(rootJ, "decimationQuality");
+		if (decimationQualityJ)
+		{
+			setDecimationQuality(json_integer_value(decimationQualityJ));
+		}
 		json_t* dcBlockJ = json_object_get(rootJ, "dcBlock");
 		if (dcBlockJ)
 		{
@@ -277,6 +718,21 @@ struct Oscillators : Module {
 		{
 			lfoMode = (json_boolean_value(lfoModeJ));
 		}
+		json_t* unisonJ = json_object_get(rootJ, "unison");
+		if (unisonJ)
+		{
+			unison = clamp((int)json_integer_value(unisonJ), 1, maxUnison);
+		}
+		json_t* cpuGovernorJ = json_object_get(rootJ, "cpuGovernor");
+		if (cpuGovernorJ)
+		{
+			governor.setEnabled(json_boolean_value(cpuGovernorJ));
+		}
+		json_t* cpuGovernorBudgetJ = json_object_get(rootJ, "cpuGovernorBudget");
+		if (cpuGovernorBudgetJ)
+		{
+			governor.setBudget(json_real_value(cpuGovernorBudgetJ));
+		}
 	}
 };
 
@@ -328,7 +784,25 @@ struct OscillatorsWidget : ModuleWidget {
 				return log2(module->oversamplingRate);
 			},
 			[=](int mode) {
-				module->setOversamplingRate(std::pow(2, mode));
+				module->commands.push(Oscillators::SET_OVERSAMPLING_RATE, std::pow(2, mode));
+			}
+		));
+
+		menu->addChild(createIndexSubmenuItem("Internal sample rate", {"Off (fixed oversampling rate)", "192 kHz", "384 kHz", "768 kHz", "1536 kHz"},
+			[=]() {
+				return module->internalSampleRate ? std::log2(module->internalSampleRate / 96000) : 0;
+			},
+			[=](int mode) {
+				module->commands.push(Oscillators::SET_INTERNAL_SAMPLE_RATE, mode ? 96000 * std::pow(2, mode) : 0);
+			}
+		));
+
+		menu->addChild(createIndexSubmenuItem("Decimation quality", {"Eco", "Standard", "Mastering"},
+			[=]() {
+				return module->decimationQuality;
+			},
+			[=](int mode) {
+				module->commands.push(Oscillators::SET_DECIMATION_QUALITY, mode);
 			}
 		));
 
@@ -337,7 +811,7 @@ struct OscillatorsWidget : ModuleWidget {
 				return module->dcBlock;
 			},
 			[=](int mode) {
-				module->dcBlock = mode;
+				module->commands.push(Oscillators::SET_DC_BLOCK, mode);
 			}
 		));
 
@@ -348,9 +822,36 @@ struct OscillatorsWidget : ModuleWidget {
 				return module->lfoMode;
 			},
 			[=](int mode) {
-				module->lfoMode = mode;
+				module->commands.push(Oscillators::SET_LFO_MODE, mode);
+			}
+		));
+
+		menu->addChild(new MenuSeparator);
+
+		menu->addChild(createIndexSubmenuItem("Unison", {"Off", "2 copies per voice (max. 8 voices)", "4 copies per voice (max. 4 voices)", "8 copies per voice (max. 2 voices)"},
+			[=]() {
+				return log2(module->unison);
+			},
+			[=](int mode) {
+				module->commands.push(Oscillators::SET_UNISON, 1 << mode);
 			}
 		));
+		if (module->unison > 1)
+		{
+			ui::Slider* detuneSlider = new ui::Slider;
+			detuneSlider->quantity = module->getParamQuantity(Oscillators::UNISON_DETUNE_PARAM);
+			detuneSlider->box.size.x = 200.f;
+			menu->addChild(detuneSlider);
+
+			ui::Slider* spreadSlider = new ui::Slider;
+			spreadSlider->quantity = module->getParamQuantity(Oscillators::UNISON_SPREAD_PARAM);
+			spreadSlider->box.size.x = 200.f;
+			menu->addChild(spreadSlider);
+		}
+
+		menu->addChild(new MenuSeparator);
+
+		appendCpuGovernorMenu(menu, &module->governor);
 	}
 };
 
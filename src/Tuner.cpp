@@ -1,4 +1,5 @@
 #include "plugin.hpp"
+#include "dsp/commands.hpp"
 
 namespace musx {
 
@@ -34,8 +35,19 @@ struct Tuner : Module {
 	bool snapSemitones = false;
 	bool newModule = true;
 
+	// settings from the context menu, applied in process()
+	enum CommandId {
+		SET_OCTAVE_RANGE,
+		SET_SNAP_OCTAVES,
+		SET_SEMI_RANGE,
+		SET_SNAP_SEMITONES
+	};
+	musx::CommandQueue<> commands;
+
 	Tuner() {
 		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
+		configParam(OCTAVE_PARAM, -octaveRange, octaveRange, 0.f, "Octave");
+		configParam(SEMI_PARAM, -semiRange, semiRange, 0.f, "Coarse tune", " cents", 0.f, 100.f);
 		setSnap();
 		configParam(FINE_PARAM, -1.f/12.f, 1.f/12.f, 0.f, "Fine tune", " cents", 0.f, 1200.f);
 
@@ -48,34 +60,59 @@ struct Tuner : Module {
 		configBypass(VOCT1_INPUT, VOCT_OUTPUT);
 	}
 
+	/**
+	 * updates the ranges of the existing param quantities, doesn't allocate, so it can run on the audio thread
+	 */
 	void setSnap()
 	{
-		float newValue = params[OCTAVE_PARAM].getValue();
-		newValue = std::min(newValue, (float)octaveRange);
-		newValue = std::max(newValue, -(float)octaveRange);
-		if (snapOctaves)
+		setSnap(OCTAVE_PARAM, octaveRange, snapOctaves);
+		setSnap(SEMI_PARAM, semiRange, snapSemitones);
+	}
+
+	void setSnap(int paramId, int range, bool snap)
+	{
+		float newValue = params[paramId].getValue();
+		newValue = std::min(newValue, (float)range);
+		newValue = std::max(newValue, -(float)range);
+		if (snap)
 		{
 			newValue = (float)(int)newValue;
 		}
-		configParam(OCTAVE_PARAM, -octaveRange, octaveRange, 0.f, "Octave");
-		getParamQuantity(OCTAVE_PARAM)->snapEnabled = snapOctaves;
-		getParamQuantity(OCTAVE_PARAM)->smoothEnabled = !snapOctaves;
-		params[OCTAVE_PARAM].setValue(newValue);
-
-		newValue = params[SEMI_PARAM].getValue();
-		newValue = std::min(newValue, (float)semiRange);
-		newValue = std::max(newValue, -(float)semiRange);
-		if (snapSemitones)
+		ParamQuantity* qty = getParamQuantity(paramId);
+		qty->minValue = -range;
+		qty->maxValue = range;
+		qty->snapEnabled = snap;
+		qty->smoothEnabled = !snap;
+		params[paramId].setValue(newValue);
+	}
+
+	void applyCommand(const musx::Command& command)
+	{
+		switch (command.id)
 		{
-			newValue = (float)(int)newValue;
+			case SET_OCTAVE_RANGE:
+				octaveRange = command.value;
+				break;
+			case SET_SNAP_OCTAVES:
+				snapOctaves = command.value;
+				break;
+			case SET_SEMI_RANGE:
+				semiRange = command.value;
+				break;
+			case SET_SNAP_SEMITONES:
+				snapSemitones = command.value;
+				break;
 		}
-		configParam(SEMI_PARAM, -semiRange, semiRange, 0.f, "Coarse tune", " cents", 0.f, 100.f);
-		getParamQuantity(SEMI_PARAM)->snapEnabled = snapSemitones;
-		getParamQuantity(SEMI_PARAM)->smoothEnabled = !snapSemitones;
-		params[SEMI_PARAM].setValue(newValue);
+		setSnap();
 	}
 
 	void process(const ProcessArgs& args) override {
+		musx::Command command;
+		while (commands.pop(command))
+		{
+			applyCommand(command);
+		}
+
 		if (newModule)
 		{
 			// default values for new modules
@@ -168,8 +205,7 @@ struct TunerWidget : ModuleWidget {
 				return module->octaveRange - 1;
 			},
 			[=](int mode) {
-				module->octaveRange = mode + 1;
-				module->setSnap();
+				module->commands.push(Tuner::SET_OCTAVE_RANGE, mode + 1);
 			}
 		));
 
@@ -178,8 +214,7 @@ struct TunerWidget : ModuleWidget {
 				return module->snapOctaves;
 			},
 			[=](int mode) {
-				module->snapOctaves = mode;
-				module->setSnap();
+				module->commands.push(Tuner::SET_SNAP_OCTAVES, mode);
 			}
 		));
 
@@ -190,8 +225,7 @@ struct TunerWidget : ModuleWidget {
 				return module->semiRange - 1;
 			},
 			[=](int mode) {
-				module->semiRange = mode + 1;
-				module->setSnap();
+				module->commands.push(Tuner::SET_SEMI_RANGE, mode + 1);
 			}
 		));
 
@@ -200,8 +234,7 @@ struct TunerWidget : ModuleWidget {
 				return module->snapSemitones;
 			},
 			[=](int mode) {
-				module->snapSemitones = mode;
-				module->setSnap();
+				module->commands.push(Tuner::SET_SNAP_SEMITONES, mode);
 			}
 		));
 	}
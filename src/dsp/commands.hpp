@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+
+namespace musx {
+
+/**
+ * A setting changed in the context menu.
+ * id is one of the CommandId values of the module, value the new setting.
+ */
+struct Command {
+	int id = 0;
+	int value = 0;
+};
+
+/**
+ * Lock-free single producer, single consumer queue from the UI thread to the audio thread.
+ *
+ * Context menu actions push() commands instead of writing module fields, and process() pop()s and applies them
+ * before processing the sample, so settings never change while process() is running.
+ * The buffer is preallocated, push() returns false if the queue is full.
+ */
+template<typename T = Command, int SIZE = 32>
+struct CommandQueue {
+	T buffer[SIZE];
+	std::atomic<int> writeIndex {0};
+	std::atomic<int> readIndex {0};
+
+	/**
+	 * UI thread only
+	 */
+	bool push(const T& command)
+	{
+		int write = writeIndex.load(std::memory_order_relaxed);
+		int next = (write + 1) % SIZE;
+		if (next == readIndex.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		buffer[write] = command;
+		writeIndex.store(next, std::memory_order_release);
+		return true;
+	}
+
+	bool push(int id, int value)
+	{
+		T command;
+		command.id = id;
+		command.value = value;
+		return push(command);
+	}
+
+	/**
+	 * audio thread only
+	 */
+	bool pop(T& command)
+	{
+		int read = readIndex.load(std::memory_order_relaxed);
+		if (read == writeIndex.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		command = buffer[read];
+		readIndex.store((read + 1) % SIZE, std::memory_order_release);
+		return true;
+	}
+};
+
+}
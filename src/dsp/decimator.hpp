@@ -1,5 +1,290 @@
+#include <mutex>
+
 namespace musx {
 
+/**
+ * Designs an equiripple half band filter with ORDER coefficients (see HalfBandDecimator::setCoeffs), with the Remez exchange algorithm.
+ * The amplitude response is H(f) = 1/2 + sum_j a_j cos(2 pi (2j-1) f), j = 1..ORDER. Since H(f) + H(1/2 - f) = 1,
+ * it suffices to minimize the maximum of |H(f)| in the stop band [1/4 + transitionBand/2, 1/2].
+ * `f` is the ratio between frequency and sample rate.
+ * Returns the maximum of |H(f)| in the stop band.
+ */
+inline double designHalfBand(int order, double transitionBand, float* coeffs)
+{
+	const double fStop = 0.25 + 0.5 * transitionBand;
+	const int gridSize = 256 * order + 1;
+	const int n = order + 1; // size of the reference set
+
+	std::vector<double> grid(gridSize);
+	std::vector<double> error(gridSize);
+	for (int i = 0; i < gridSize; ++i)
+	{
+		grid[i] = fStop + (0.5 - fStop) * i / (gridSize - 1);
+	}
+
+	// initial reference set: equidistant
+	std::vector<int> reference(n);
+	for (int i = 0; i < n; ++i)
+	{
+		reference[i] = i * (gridSize - 1) / order;
+	}
+
+	std::vector<double> a(order, 0.);
+	std::vector<double> matrix(n * (n + 1));
+	double maxError = 1.;
+
+	for (int iteration = 0; iteration < 100; ++iteration)
+	{
+		// solve H(f_i) = (-1)^i delta on the reference set for a_1..a_order and delta
+		for (int i = 0; i < n; ++i)
+		{
+			double* row = &matrix[i * (n + 1)];
+			for (int j = 0; j < order; ++j)
+			{
+				row[j] = std::cos(2. * M_PI * (2 * j + 1) * grid[reference[i]]);
+			}
+			row[order] = (i % 2) ? 1. : -1.;
+			row[n] = -0.5;
+		}
+
+		// Gaussian elimination with partial pivoting
+		for (int k = 0; k < n; ++k)
+		{
+			int pivot = k;
+			for (int i = k + 1; i < n; ++i)
+			{
+				if (std::fabs(matrix[i * (n + 1) + k]) > std::fabs(matrix[pivot * (n + 1) + k]))
+				{
+					pivot = i;
+				}
+			}
+			for (int j = 0; j <= n; ++j)
+			{
+				std::swap(matrix[k * (n + 1) + j], matrix[pivot * (n + 1) + j]);
+			}
+			for (int i = k + 1; i < n; ++i)
+			{
+				double factor = matrix[i * (n + 1) + k] / matrix[k * (n + 1) + k];
+				for (int j = k; j <= n; ++j)
+				{
+					matrix[i * (n + 1) + j] -= factor * matrix[k * (n + 1) + j];
+				}
+			}
+		}
+		std::vector<double> x(n);
+		for (int i = n - 1; i >= 0; --i)
+		{
+			double sum = matrix[i * (n + 1) + n];
+			for (int j = i + 1; j < n; ++j)
+			{
+				sum -= matrix[i * (n + 1) + j] * x[j];
+			}
+			x[i] = sum / matrix[i * (n + 1) + i];
+		}
+		for (int j = 0; j < order; ++j)
+		{
+			a[j] = x[j];
+		}
+		double delta = std::fabs(x[order]);
+
+		// error on the grid
+		maxError = 0.;
+		for (int i = 0; i < gridSize; ++i)
+		{
+			// cos((2j+1) w) with the recurrence cos((2j+3) w) = 2 cos(2w) cos((2j+1) w) - cos((2j-1) w)
+			double twoCos2w = 2. * std::cos(4. * M_PI * grid[i]);
+			double cosPrev = std::cos(2. * M_PI * grid[i]);
+			double cosCurrent = cosPrev;
+			error[i] = 0.5;
+			for (int j = 0; j < order; ++j)
+			{
+				error[i] += a[j] * cosCurrent;
+				double cosNext = twoCos2w * cosCurrent - cosPrev;
+				cosPrev = cosCurrent;
+				cosCurrent = cosNext;
+			}
+			maxError = std::max(maxError, std::fabs(error[i]));
+		}
+
+		if (maxError - delta <= 1e-6 * maxError)
+		{
+			break;
+		}
+
+		// new reference set: the extremum of each interval where the error has constant sign
+		std::vector<int> extrema;
+		for (int i = 0; i < gridSize; ++i)
+		{
+			if (!extrema.empty() && (error[extrema.back()] > 0) == (error[i] > 0))
+			{
+				if (std::fabs(error[i]) > std::fabs(error[extrema.back()]))
+				{
+					extrema.back() = i;
+				}
+			}
+			else
+			{
+				extrema.push_back(i);
+			}
+		}
+		// drop the smaller one of the outermost extrema until the size fits
+		while ((int)extrema.size() > n)
+		{
+			if (std::fabs(error[extrema.front()]) < std::fabs(error[extrema.back()]))
+			{
+				extrema.erase(extrema.begin());
+			}
+			else
+			{
+				extrema.pop_back();
+			}
+		}
+		if ((int)extrema.size() < n)
+		{
+			break;
+		}
+		reference = extrema;
+	}
+
+	// the coefficients are ordered from the outermost tap to the one next to the center tap
+	for (int k = 0; k < order; ++k)
+	{
+		coeffs[k] = 0.5 * a[order - 1 - k];
+	}
+
+	return maxError;
+}
+
+/**
+ * Coefficients of an equiripple half band filter with ORDER coefficients and a transition band of TRANSITION_NUM/TRANSITION_DEN.
+ * They are designed once, on first use, and shared by all instances.
+ */
+template <int ORDER, int TRANSITION_NUM, int TRANSITION_DEN>
+struct HalfBandCoeffs {
+	static const int order = ORDER;
+
+	float coeffs[ORDER];
+	double stopBandError;
+
+	HalfBandCoeffs()
+	{
+		stopBandError = designHalfBand(ORDER, transitionBand(), coeffs);
+	}
+
+	static const HalfBandCoeffs& instance()
+	{
+		static const HalfBandCoeffs instance;
+		return instance;
+	}
+
+	static const float* get()
+	{
+		return instance().coeffs;
+	}
+
+	static double transitionBand()
+	{
+		return (double)TRANSITION_NUM / TRANSITION_DEN;
+	}
+
+	/**
+	 * Writes the ORDER coefficients for a pass band up to passBand (ratio of frequency and output sample rate of the half band filter) to coeffs.
+	 * The transition band is never narrower than the default one. For very wide transition bands the design becomes
+	 * ill-conditioned, then the transition band is narrowed until the design is better than the default one.
+	 * The last design is cached and shared by all instances, the cache is guarded by a mutex, so modules can call this
+	 * from their own threads. The design takes a few milliseconds, call it from onSampleRateChange, not from process.
+	 */
+	static void getForPassBand(double passBand, float* coeffs)
+	{
+		static std::mutex mutex;
+		static double cachedPassBand = -1.;
+		static float cachedCoeffs[ORDER];
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (passBand != cachedPassBand)
+		{
+			cachedPassBand = passBand;
+			std::memcpy(cachedCoeffs, get(), ORDER * sizeof(float));
+
+			double transition = std::min(0.5 - passBand, 0.49);
+			for (int i = 0; i < 8 && transition > transitionBand(); ++i)
+			{
+				float design[ORDER];
+				if (designHalfBand(ORDER, transition, design) < instance().stopBandError)
+				{
+					std::memcpy(cachedCoeffs, design, ORDER * sizeof(float));
+					break;
+				}
+				transition = 0.5 * (transition + transitionBand());
+			}
+		}
+
+		std::memcpy(coeffs, cachedCoeffs, ORDER * sizeof(float));
+	}
+};
+
+/**
+ * Quality tiers for HalfBandDecimatorCascade and HalfBandInterpolatorCascade.
+ * CoeffsN are the coefficients of the stages at N times the sample rate and above.
+ * The transition band of the 2x stage sets the pass band, e.g. 0.0625 is 21 kHz at 48 kHz sample rate.
+ * The comments give the stop band attenuation of the design, see tests/halfband_test.cpp. Below about -150 dB the
+ * rounding of the coefficients to float limits it, that figure is given too.
+ */
+struct HalfBandQualityEco {
+	typedef HalfBandCoeffs<1, 127, 256> Coeffs256; // -94.5 dB
+	typedef HalfBandCoeffs<1, 15, 32> Coeffs32; // -58 dB
+	typedef HalfBandCoeffs<2, 3, 8> Coeffs8; // -65 dB
+	typedef HalfBandCoeffs<4, 1, 4> Coeffs4; // -72 dB
+	typedef HalfBandCoeffs<10, 1, 10> Coeffs2; // -69 dB, 19 kHz pass band
+};
+
+struct HalfBandQualityStandard {
+	typedef HalfBandCoeffs<1, 127, 256> Coeffs256; // -94.5 dB, same as the old coefficient table, which said -100 dB
+	typedef HalfBandCoeffs<2, 15, 32> Coeffs32; // -113 dB
+	typedef HalfBandCoeffs<3, 3, 8> Coeffs8; // -94 dB
+	typedef HalfBandCoeffs<6, 1, 4> Coeffs4; // -104 dB
+	typedef HalfBandCoeffs<22, 1, 16> Coeffs2; // -91 dB, 21 kHz pass band
+};
+
+struct HalfBandQualityMastering {
+	typedef HalfBandCoeffs<2, 127, 256> Coeffs256; // -185 dB, -150 dB with float coefficients
+	typedef HalfBandCoeffs<3, 15, 32> Coeffs32; // -167 dB, -152 dB with float coefficients
+	typedef HalfBandCoeffs<4, 3, 8> Coeffs8; // -123 dB
+	typedef HalfBandCoeffs<8, 1, 4> Coeffs4; // -136 dB
+	typedef HalfBandCoeffs<32, 1, 16> Coeffs2; // -127 dB, 21 kHz pass band
+};
+
+/**
+ * Group delay of a HalfBandDecimatorCascade of quality tier Q, in samples at the output sample rate.
+ * Each stage with input rate m delays by 2 * order - 1 samples at its input rate.
+ */
+template <typename Q>
+inline float halfBandCascadeLatency(int inputlength)
+{
+	float latency = 0.f;
+	for (int m = 2; m <= inputlength; m *= 2)
+	{
+		int order = m >= 256 ? Q::Coeffs256::order : m >= 32 ? Q::Coeffs32::order : m >= 8 ? Q::Coeffs8::order : m >= 4 ? Q::Coeffs4::order : Q::Coeffs2::order;
+		latency += (2.f * order - 1.f) / m;
+	}
+	return latency;
+}
+
+/** smallest power of 2 multiple of length that is >= minLength, for the MAXINPUTLENGTH of the cascade stages */
+constexpr int halfBandBufferLength(int length, int minLength)
+{
+	return length >= minLength ? length : halfBandBufferLength(2 * length, minLength);
+}
+
+/**
+ * Power of 2 oversampling rate, up to maxOversamplingRate, that brings sampleRate closest to internalSampleRate
+ */
+inline int oversamplingRateFor(float internalSampleRate, float sampleRate, int maxOversamplingRate)
+{
+	int factor = std::max(0.f, std::round(std::log2(internalSampleRate / sampleRate)));
+	return std::min(1 << factor, maxOversamplingRate);
+}
+
 /** Downsamples by a factor 2.
   * MAXINPUTLENGTH must be power of 2 and > 2*ORDER
   *
@@ -32,6 +317,15 @@ struct HalfBandDecimator {
 		std::memcpy(&coeffs[0], arg, ORDER * sizeof(float));
 	}
 
+	/** zeroes only the past input samples which process() reads, a fraction of the buffer of reset() */
+	void clearHistory(int order = ORDER)
+	{
+		for (int k = 1; k <= 4*order - 2; k++)
+		{
+			inBuffer[(inIndex + 2*MAXINPUTLENGTH - k) & (2*MAXINPUTLENGTH-1)] = 0.f;
+		}
+	}
+
 	/**
 	 * write input with inputlength to this array, then call process(out, inputlength)
 	 */
@@ -43,14 +337,18 @@ struct HalfBandDecimator {
 	/** inputlength must be power of 2
 	  * `out` will be filled up to inputlength/2 */
 	void process(T* out, const int inputlength) {
-		// Perform convolution
+		processOrder(out, inputlength, ORDER);
+	}
+
+	/** convolution with the first `order` coefficients, the compiler unrolls it for order == ORDER */
+	inline void processOrder(T* out, const int inputlength, const int order) {
 		for (int o = 0; o < inputlength/2; o++) { // loop over output samples to be calculated
 
-			out[o] = 0.5f * inBuffer[(inIndex + 2*o + 2*MAXINPUTLENGTH - (2*ORDER - 1)) & (2*MAXINPUTLENGTH-1)];
-			for (int k = 0; k < ORDER; k++) { // loop over kernel
+			out[o] = 0.5f * inBuffer[(inIndex + 2*o + 2*MAXINPUTLENGTH - (2*order - 1)) & (2*MAXINPUTLENGTH-1)];
+			for (int k = 0; k < order; k++) { // loop over kernel
 				out[o] += coeffs[k] *
 						(inBuffer[(inIndex + 2*o + 2*MAXINPUTLENGTH                 - 2*k) & (2*MAXINPUTLENGTH-1)]  +
-						 inBuffer[(inIndex + 2*o + 2*MAXINPUTLENGTH - (4*ORDER - 2) + 2*k) & (2*MAXINPUTLENGTH-1)]);
+						 inBuffer[(inIndex + 2*o + 2*MAXINPUTLENGTH - (4*order - 2) + 2*k) & (2*MAXINPUTLENGTH-1)]);
 			}
 		}
 
@@ -59,50 +357,143 @@ struct HalfBandDecimator {
 	}
 };
 
-template <typename T = float>
+/** HalfBandDecimator whose order can be changed at runtime, up to MAXORDER, e.g. for another quality tier */
+template <int MAXINPUTLENGTH, int MAXORDER, typename T = float>
+struct HalfBandDecimatorVariableOrder : HalfBandDecimator<MAXINPUTLENGTH, MAXORDER, T> {
+	int order = MAXORDER;
+
+	/** takes n coefficients, see HalfBandDecimator::setCoeffs */
+	void setCoeffs(const float* arg, int n = MAXORDER)
+	{
+		order = std::min(n, MAXORDER);
+		std::memcpy(&this->coeffs[0], arg, order * sizeof(float));
+	}
+
+	void clearHistory()
+	{
+		HalfBandDecimator<MAXINPUTLENGTH, MAXORDER, T>::clearHistory(order);
+	}
+
+	void process(T* out, const int inputlength) {
+		this->processOrder(out, inputlength, order);
+	}
+};
+
+/** Upsamples by a factor 2, with the same half band FIR filter as HalfBandDecimator.
+  * MAXINPUTLENGTH must be power of 2 and >= 2*ORDER
+  *
+  * The zero-stuffed input is never formed, the two output phases are computed directly (polyphase):
+  * the even output samples are the convolution with [a, b, b, a], the odd ones are the delayed input.
+  * */
+template <int MAXINPUTLENGTH, int ORDER, typename T = float>
+struct HalfBandInterpolator {
+	static_assert(MAXINPUTLENGTH>0 && ((MAXINPUTLENGTH & (MAXINPUTLENGTH-1)) == 0), "MAXINPUTLENGTH must be power of 2");
+	static_assert(MAXINPUTLENGTH >= 2*ORDER, "MAXINPUTLENGTH too small for ORDER");
+
+	T inBuffer[2*MAXINPUTLENGTH] = {0};
+	float coeffs[ORDER] = {0};
+
+	int inIndex = 0;
+
+	HalfBandInterpolator() {
+		reset();
+	}
+
+	void reset() {
+		inIndex = 0;
+		std::memset(inBuffer, 0, sizeof(inBuffer));
+	}
+
+	/** takes the same coefficients as HalfBandDecimator::setCoeffs */
+	void setCoeffs(const float* arg)
+	{
+		// gain 2 compensates for the zero stuffing
+		for (int k = 0; k < ORDER; k++)
+		{
+			coeffs[k] = 2.f * arg[k];
+		}
+	}
+
+	/**
+	 * write input with inputlength to this array, then call process(out, inputlength)
+	 */
+	T* getInputArray()
+	{
+		return &inBuffer[inIndex];
+	}
+
+	/** inputlength must be power of 2
+	  * `out` will be filled up to 2*inputlength */
+	void process(T* out, const int inputlength) {
+		for (int i = 0; i < inputlength; i++) { // loop over input samples
+			int n = inIndex + i + 2*MAXINPUTLENGTH;
+
+			out[2*i] = 0.f;
+			for (int k = 0; k < ORDER; k++) { // loop over kernel
+				out[2*i] += coeffs[k] *
+						(inBuffer[(n                 - k) & (2*MAXINPUTLENGTH-1)] +
+						 inBuffer[(n - (2*ORDER - 1) + k) & (2*MAXINPUTLENGTH-1)]);
+			}
+
+			out[2*i + 1] = inBuffer[(n - (ORDER - 1)) & (2*MAXINPUTLENGTH-1)];
+		}
+
+		// advance index
+		inIndex = (inIndex + inputlength) & (2*MAXINPUTLENGTH-1);
+	}
+};
+
+/**
+ * Downsamples by a power of 2, up to 1024, with a cascade of HalfBandDecimators.
+ * Q is the quality tier, e.g. HalfBandQualityStandard
+ * STAGE is the type of the stages, HalfBandDecimatorVariableOrder allows to load a tier with lower orders than Q.
+ */
+template <typename T = float, typename Q = HalfBandQualityStandard, template <int, int, typename> class STAGE = HalfBandDecimator>
 struct HalfBandDecimatorCascade {
-	HalfBandDecimator<1024, 1, T> decimator1024; // decimate down to 512x
-	HalfBandDecimator< 512, 1, T> decimator512; // decimate down to 256x
-	HalfBandDecimator< 256, 1, T> decimator256; // decimate down to 128x
+	STAGE<halfBandBufferLength(1024, 4 * Q::Coeffs256::order + 1), Q::Coeffs256::order, T> decimator1024; // decimate down to 512x
+	STAGE<halfBandBufferLength(512, 4 * Q::Coeffs256::order + 1), Q::Coeffs256::order, T> decimator512; // decimate down to 256x
+	STAGE<halfBandBufferLength(256, 4 * Q::Coeffs256::order + 1), Q::Coeffs256::order, T> decimator256; // decimate down to 128x
 
-	HalfBandDecimator<128, 2, T> decimator128; // decimate down to 64
-	HalfBandDecimator< 64, 2, T> decimator64; // decimate down to 32x
-	HalfBandDecimator< 32, 2, T> decimator32; // decimate down to 16x
+	STAGE<halfBandBufferLength(128, 4 * Q::Coeffs32::order + 1), Q::Coeffs32::order, T> decimator128; // decimate down to 64
+	STAGE<halfBandBufferLength(64, 4 * Q::Coeffs32::order + 1), Q::Coeffs32::order, T> decimator64; // decimate down to 32x
+	STAGE<halfBandBufferLength(32, 4 * Q::Coeffs32::order + 1), Q::Coeffs32::order, T> decimator32; // decimate down to 16x
 
-	HalfBandDecimator<16, 3, T> decimator16; // decimate down to 8x
-	HalfBandDecimator<16, 3, T> decimator8; // decimate down to 4x
+	STAGE<halfBandBufferLength(16, 4 * Q::Coeffs8::order + 1), Q::Coeffs8::order, T> decimator16; // decimate down to 8x
+	STAGE<halfBandBufferLength(8, 4 * Q::Coeffs8::order + 1), Q::Coeffs8::order, T> decimator8; // decimate down to 4x
 
-	HalfBandDecimator<32, 6, T> decimator4; // decimate down to 2x
+	STAGE<halfBandBufferLength(4, 4 * Q::Coeffs4::order + 1), Q::Coeffs4::order, T> decimator4; // decimate down to 2x
 
-	HalfBandDecimator<128, 22, T> decimator2; // decimate down to 1x
+	STAGE<halfBandBufferLength(2, 4 * Q::Coeffs2::order + 1), Q::Coeffs2::order, T> decimator2; // decimate down to 1x
 
 	T outBuffer[1];
 
 	HalfBandDecimatorCascade() {
-		// transition band: 0.49609375; stop band attenuation: -100 dB
-		float coeffs256[1] = {0.2500094126245982};
-		decimator1024.setCoeffs(coeffs256);
-		decimator512.setCoeffs(coeffs256);
-		decimator256.setCoeffs(coeffs256);
+		decimator1024.setCoeffs(Q::Coeffs256::get());
+		decimator512.setCoeffs(Q::Coeffs256::get());
+		decimator256.setCoeffs(Q::Coeffs256::get());
 
-		// transition band: 0.46875; stop band attenuation: -113 dB
-		float coeffs32[2] = {-0.03147685303471284, 0.2814757608962846};
-		decimator128.setCoeffs(coeffs32);
-		decimator64.setCoeffs(coeffs32);
-		decimator32.setCoeffs(coeffs32);
+		decimator128.setCoeffs(Q::Coeffs32::get());
+		decimator64.setCoeffs(Q::Coeffs32::get());
+		decimator32.setCoeffs(Q::Coeffs32::get());
 
-		// transition band: 0.375; stop band attenuation: -94 dB
-		float coeffs8[3] = {0.0071174511083665504, -0.05231169587073679, 0.2952039278517196};
-		decimator16.setCoeffs(coeffs8);
-		decimator8.setCoeffs(coeffs8);
+		decimator16.setCoeffs(Q::Coeffs8::get());
+		decimator8.setCoeffs(Q::Coeffs8::get());
 
-		// transition band: 0.25; stop band attenuation: -104 dB
-		float coeffs4[6] = {-0.00034696754642661164, 0.0025132384125000433, -0.010158904818112154, 0.030552323579531526, -0.08198144832535462, 0.3094188471351897};
-		decimator4.setCoeffs(coeffs4);
+		decimator4.setCoeffs(Q::Coeffs4::get());
 
-		// transition band: 0.0625; stop band attenuation: -91 dB
-		float coeffs2[22] = {-3.78984774783134e-05, 7.863590263960349e-05, -0.00015644609673577748, 0.000280705554967871, -0.00046880653545378965, 0.0007418705114406702, -0.0011250733106933466, 0.0016480557249014232, -0.0023455500288496497, 0.003258444430478961, -0.004435660674522054, 0.005937492977997016, -0.007841575438896764, 0.010253701642225216, -0.013328034730955753, 0.01730676011216719, -0.0226037708095706, 0.030000600584212778, -0.04117865039985172, 0.06052862461039207, -0.10419628766252699, 0.3176696599347577};
-		decimator2.setCoeffs(coeffs2);
+		decimator2.setCoeffs(Q::Coeffs2::get());
+	}
+
+	/**
+	 * Redesigns the 2x stage for a pass band up to passBand (ratio of frequency and output sample rate).
+	 * At high sample rates, the wider transition band gives more stop band attenuation for the same order.
+	 * The transition band is never narrower than the one of the quality tier.
+	 */
+	void setPassBand(double passBand)
+	{
+		float coeffs[Q::Coeffs2::order];
+		Q::Coeffs2::getForPassBand(passBand, coeffs);
+		decimator2.setCoeffs(coeffs);
 	}
 
 	void reset() {
@@ -118,6 +509,45 @@ struct HalfBandDecimatorCascade {
 		decimator2.reset();
 	}
 
+	/**
+	 * Clears the history of the stages used for inputlength, see HalfBandDecimator::clearHistory.
+	 * The stages of higher rates are not used, they are cleared when they are used again.
+	 */
+	void clearHistory(int inputlength) {
+		switch (inputlength)
+		{
+			case 1024:
+				decimator1024.clearHistory();
+				[[fallthrough]];
+			case 512:
+				decimator512.clearHistory();
+				[[fallthrough]];
+			case 256:
+				decimator256.clearHistory();
+				[[fallthrough]];
+			case 128:
+				decimator128.clearHistory();
+				[[fallthrough]];
+			case 64:
+				decimator64.clearHistory();
+				[[fallthrough]];
+			case 32:
+				decimator32.clearHistory();
+				[[fallthrough]];
+			case 16:
+				decimator16.clearHistory();
+				[[fallthrough]];
+			case 8:
+				decimator8.clearHistory();
+				[[fallthrough]];
+			case 4:
+				decimator4.clearHistory();
+				[[fallthrough]];
+			case 2:
+				decimator2.clearHistory();
+		}
+	}
+
 	/**
 	 * write input with inputlength to this array, then call process(inputlength)
 	 */
@@ -189,4 +619,284 @@ struct HalfBandDecimatorCascade {
 	}
 };
 
-}
+/**
+ * Upsamples by a power of 2, up to 1024, with a cascade of HalfBandInterpolators.
+ * Q is the quality tier, e.g. HalfBandQualityStandard
+ */
+template <typename T = float, typename Q = HalfBandQualityStandard>
+struct HalfBandInterpolatorCascade {
+	HalfBandInterpolator<halfBandBufferLength(1, 2 * Q::Coeffs2::order), Q::Coeffs2::order, T> interpolator2; // interpolate up to 2x
+
+	HalfBandInterpolator<halfBandBufferLength(2, 2 * Q::Coeffs4::order), Q::Coeffs4::order, T> interpolator4; // interpolate up to 4x
+
+	HalfBandInterpolator<halfBandBufferLength(4, 2 * Q::Coeffs8::order), Q::Coeffs8::order, T> interpolator8; // interpolate up to 8x
+	HalfBandInterpolator<halfBandBufferLength(8, 2 * Q::Coeffs8::order), Q::Coeffs8::order, T> interpolator16; // interpolate up to 16x
+
+	HalfBandInterpolator<halfBandBufferLength(16, 2 * Q::Coeffs32::order), Q::Coeffs32::order, T> interpolator32; // interpolate up to 32x
+	HalfBandInterpolator<halfBandBufferLength(32, 2 * Q::Coeffs32::order), Q::Coeffs32::order, T> interpolator64; // interpolate up to 64x
+	HalfBandInterpolator<halfBandBufferLength(64, 2 * Q::Coeffs32::order), Q::Coeffs32::order, T> interpolator128; // interpolate up to 128x
+
+	HalfBandInterpolator<halfBandBufferLength(128, 2 * Q::Coeffs256::order), Q::Coeffs256::order, T> interpolator256; // interpolate up to 256x
+	HalfBandInterpolator<halfBandBufferLength(256, 2 * Q::Coeffs256::order), Q::Coeffs256::order, T> interpolator512; // interpolate up to 512x
+	HalfBandInterpolator<halfBandBufferLength(512, 2 * Q::Coeffs256::order), Q::Coeffs256::order, T> interpolator1024; // interpolate up to 1024x
+
+	T outBuffer[1024];
+
+	HalfBandInterpolatorCascade() {
+		// same filters as the matching HalfBandDecimatorCascade stages
+		interpolator2.setCoeffs(Q::Coeffs2::get());
+
+		interpolator4.setCoeffs(Q::Coeffs4::get());
+
+		interpolator8.setCoeffs(Q::Coeffs8::get());
+		interpolator16.setCoeffs(Q::Coeffs8::get());
+
+		interpolator32.setCoeffs(Q::Coeffs32::get());
+		interpolator64.setCoeffs(Q::Coeffs32::get());
+		interpolator128.setCoeffs(Q::Coeffs32::get());
+
+		interpolator256.setCoeffs(Q::Coeffs256::get());
+		interpolator512.setCoeffs(Q::Coeffs256::get());
+		interpolator1024.setCoeffs(Q::Coeffs256::get());
+	}
+
+	void reset() {
+		interpolator2.reset();
+		interpolator4.reset();
+		interpolator8.reset();
+		interpolator16.reset();
+		interpolator32.reset();
+		interpolator64.reset();
+		interpolator128.reset();
+		interpolator256.reset();
+		interpolator512.reset();
+		interpolator1024.reset();
+	}
+
+	/**
+	 * upsamples one input sample to outputlength samples (power of 2, up to 1024)
+	 * returns the output array, which is valid until the next call
+	 */
+	T* process(T in, int outputlength) {
+		if (outputlength < 2)
+		{
+			outBuffer[0] = in;
+			return outBuffer;
+		}
+
+		interpolator2.getInputArray()[0] = in;
+		if (outputlength == 2)
+		{
+			interpolator2.process(outBuffer, 1);
+			return outBuffer;
+		}
+
+		interpolator2.process(interpolator4.getInputArray(), 1);
+		if (outputlength == 4)
+		{
+			interpolator4.process(outBuffer, 2);
+			return outBuffer;
+		}
+
+		interpolator4.process(interpolator8.getInputArray(), 2);
+		if (outputlength == 8)
+		{
+			interpolator8.process(outBuffer, 4);
+			return outBuffer;
+		}
+
+		interpolator8.process(interpolator16.getInputArray(), 4);
+		if (outputlength == 16)
+		{
+			interpolator16.process(outBuffer, 8);
+			return outBuffer;
+		}
+
+		interpolator16.process(interpolator32.getInputArray(), 8);
+		if (outputlength == 32)
+		{
+			interpolator32.process(outBuffer, 16);
+			return outBuffer;
+		}
+
+		interpolator32.process(interpolator64.getInputArray(), 16);
+		if (outputlength == 64)
+		{
+			interpolator64.process(outBuffer, 32);
+			return outBuffer;
+		}
+
+		interpolator64.process(interpolator128.getInputArray(), 32);
+		if (outputlength == 128)
+		{
+			interpolator128.process(outBuffer, 64);
+			return outBuffer;
+		}
+
+		interpolator128.process(interpolator256.getInputArray(), 64);
+		if (outputlength == 256)
+		{
+			interpolator256.process(outBuffer, 128);
+			return outBuffer;
+		}
+
+		interpolator256.process(interpolator512.getInputArray(), 128);
+		if (outputlength == 512)
+		{
+			interpolator512.process(outBuffer, 256);
+			return outBuffer;
+		}
+
+		interpolator512.process(interpolator1024.getInputArray(), 256);
+		interpolator1024.process(outBuffer, 512);
+		return outBuffer;
+	}
+};
+
+
+/**
+ * HalfBandDecimatorCascade with a quality tier that can be selected at runtime:
+ * 0 = HalfBandQualityEco, 1 = HalfBandQualityStandard, 2 = HalfBandQualityMastering
+ * There is only one cascade, its stage buffers are sized for the orders of the Mastering tier, which are the highest.
+ * A change of the tier loads the coefficients and orders of the tier, the state is kept, see clearHistory and reset.
+ */
+template <typename T = float>
+struct MultiQualityDecimatorCascade {
+	HalfBandDecimatorCascade<T, HalfBandQualityMastering, HalfBandDecimatorVariableOrder> cascade;
+
+	int quality = 1;
+
+	// coefficients of the 2x stage of each tier for the pass band of setPassBand
+	float passBandCoeffs[3][HalfBandQualityMastering::Coeffs2::order];
+
+	MultiQualityDecimatorCascade() {
+		std::memcpy(passBandCoeffs[0], HalfBandQualityEco::Coeffs2::get(), HalfBandQualityEco::Coeffs2::order * sizeof(float));
+		std::memcpy(passBandCoeffs[1], HalfBandQualityStandard::Coeffs2::get(), HalfBandQualityStandard::Coeffs2::order * sizeof(float));
+		std::memcpy(passBandCoeffs[2], HalfBandQualityMastering::Coeffs2::get(), HalfBandQualityMastering::Coeffs2::order * sizeof(float));
+		loadCoeffs();
+	}
+
+	void setQuality(int arg)
+	{
+		quality = arg;
+		loadCoeffs();
+	}
+
+	/**
+	 * see HalfBandDecimatorCascade::setPassBand, designs the 2x stage of all tiers
+	 */
+	void setPassBand(double passBand)
+	{
+		HalfBandQualityEco::Coeffs2::getForPassBand(passBand, passBandCoeffs[0]);
+		HalfBandQualityStandard::Coeffs2::getForPassBand(passBand, passBandCoeffs[1]);
+		HalfBandQualityMastering::Coeffs2::getForPassBand(passBand, passBandCoeffs[2]);
+		loadCoeffs();
+	}
+
+	void reset() {
+		cascade.reset();
+	}
+
+	/**
+	 * see HalfBandDecimatorCascade::clearHistory
+	 */
+	void clearHistory(int inputlength) {
+		cascade.clearHistory(inputlength);
+	}
+
+	/**
+	 * group delay of the selected tier, in samples at the output sample rate
+	 */
+	float getLatency(int inputlength)
+	{
+		switch (quality)
+		{
+			case 0:
+				return halfBandCascadeLatency<HalfBandQualityEco>(inputlength);
+			case 2:
+				return halfBandCascadeLatency<HalfBandQualityMastering>(inputlength);
+			default:
+				return halfBandCascadeLatency<HalfBandQualityStandard>(inputlength);
+		}
+	}
+
+	/**
+	 * write input with inputlength to this array, then call process(inputlength)
+	 */
+	T* getInputArray(int inputlength)
+	{
+		return cascade.getInputArray(inputlength);
+	}
+
+	T process(int inputlength) {
+		return cascade.process(inputlength);
+	}
+
+	/** load the coefficients and orders of tier Q, coeffs2 are the ones of the 2x stage */
+	template <typename Q>
+	void loadCoeffs(const float* coeffs2)
+	{
+		cascade.decimator1024.setCoeffs(Q::Coeffs256::get(), Q::Coeffs256::order);
+		cascade.decimator512.setCoeffs(Q::Coeffs256::get(), Q::Coeffs256::order);
+		cascade.decimator256.setCoeffs(Q::Coeffs256::get(), Q::Coeffs256::order);
+
+		cascade.decimator128.setCoeffs(Q::Coeffs32::get(), Q::Coeffs32::order);
+		cascade.decimator64.setCoeffs(Q::Coeffs32::get(), Q::Coeffs32::order);
+		cascade.decimator32.setCoeffs(Q::Coeffs32::get(), Q::Coeffs32::order);
+
+		cascade.decimator16.setCoeffs(Q::Coeffs8::get(), Q::Coeffs8::order);
+		cascade.decimator8.setCoeffs(Q::Coeffs8::get(), Q::Coeffs8::order);
+
+		cascade.decimator4.setCoeffs(Q::Coeffs4::get(), Q::Coeffs4::order);
+
+		cascade.decimator2.setCoeffs(coeffs2, Q::Coeffs2::order);
+	}
+
+	/** load the selected tier */
+	void loadCoeffs()
+	{
+		switch (quality)
+		{
+			case 0:
+				loadCoeffs<HalfBandQualityEco>(passBandCoeffs[0]);
+				break;
+			case 2:
+				loadCoeffs<HalfBandQualityMastering>(passBandCoeffs[2]);
+				break;
+			default:
+				loadCoeffs<HalfBandQualityStandard>(passBandCoeffs[1]);
+		}
+	}
+};
+
+
+/**
+ * Runs a memoryless nonlinearity at N times the sample rate:
+ * y = oversampler.process(x, [](T x) { return musx::tanh(x); });
+ * Round trip latency is about 43 samples at 2x and about 51 samples at higher rates, mostly from the steep 2x stages.
+ * */
+template <typename T, int N>
+struct Oversampler {
+	static_assert(N>0 && N<=1024 && ((N & (N-1)) == 0), "N must be power of 2, up to 1024");
+
+	HalfBandInterpolatorCascade<T> interpolator;
+	HalfBandDecimatorCascade<T> decimator;
+
+	void reset() {
+		interpolator.reset();
+		decimator.reset();
+	}
+
+	template <typename F>
+	T process(T in, F f) {
+		T* up = interpolator.process(in, N);
+		T* down = decimator.getInputArray(N);
+		for (int i = 0; i < N; i++)
+		{
+			down[i] = f(up[i]);
+		}
+		return decimator.process(N);
+	}
+};
+
+}
\ No newline at end of file
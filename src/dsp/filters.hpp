@@ -1,10 +1,43 @@
 #include <rack.hpp>
+#include <cstring>
 
 namespace musx {
 
 using namespace rack;
 using simd::float_4;
 
+/**
+ * 2^xi for integer valued xi in [-126, 126], via the exponent bits
+ */
+inline float exp2Int(float xi)
+{
+	int32_t e = ((int32_t)xi + 127) << 23;
+	float y;
+	std::memcpy(&y, &e, sizeof(y));
+	return y;
+}
+
+inline float_4 exp2Int(float_4 xi)
+{
+	__m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(xi.v), _mm_set1_epi32(127)), 23);
+	return float_4(_mm_castsi128_ps(e));
+}
+
+/**
+ * 2^x, with a polynomial approximation of 2^x on [0, 1), relative error < 2e-7
+ * Much cheaper than simd::exp, for mapping voltages to cutoff frequencies at audio rate.
+ * T is float or float_4.
+ */
+template <typename T>
+inline T exp2Fast(T x)
+{
+	x = simd::fmin(simd::fmax(x, -126.f), 126.f);
+	T xi = simd::floor(x);
+	T f = x - xi;
+	T p = 1.f + f * (0.693151591f + f * (0.240164346f + f * (0.0557938212f + f * (0.0090310531f + f * 0.00185880868f))));
+	return p * exp2Int(xi);
+}
+
 /**
  * 1 pole lowpass/highpass
  */
@@ -43,6 +76,17 @@ struct TOnePole {
 		b = -x;
 	}
 
+	/** Sets the cutoff frequency from its base 2 logarithm, i.e. f = 2^log2f.
+	Same as setCutoffFreq, but cheap enough to be called every sample:
+	exp2Fast instead of simd::exp, and a polynomial for a = 1 - exp(-2*pi*f), which is also accurate for small f.
+	*/
+	void setCutoffFreqLog2(T log2f) {
+		T f = simd::fmin(exp2Fast(log2f), 0.3f);
+		T w = (float)(2. * M_PI) * f;
+		a = w * (1.f + w * (-0.499993511f + w * (0.166607817f + w * (-0.0414766118f + w * (0.00803730806f + w * (-0.00114348768f + w * 8.90236053e-05f))))));
+		b = a - 1.0f;
+	}
+
 	void process(T x) {
 		in = x;
 		tmp = a*x - b*tmp;
@@ -53,6 +97,38 @@ struct TOnePole {
 		return tmp;
 	}
 
+	/** Processes a block of n samples, writes the lowpass output.
+	Same result as calling process() and lowpass() per sample, but the state stays in registers.
+	`input` and `output` may be the same array.
+	*/
+	void processBlockLowpass(const T* input, T* output, int n) {
+		processBlock<false>(input, output, n);
+	}
+
+	/** Processes a block of n samples, writes the highpass output */
+	void processBlockHighpass(const T* input, T* output, int n) {
+		processBlock<true>(input, output, n);
+	}
+
+	template <bool HIGHPASS>
+	void processBlock(const T* input, T* output, int n) {
+		if (n <= 0)
+		{
+			return;
+		}
+
+		T y = tmp;
+		T x = in;
+		for (int i = 0; i < n; ++i)
+		{
+			x = input[i];
+			y = a*x - b*y;
+			output[i] = HIGHPASS ? x - y : y;
+		}
+		in = x;
+		tmp = y;
+	}
+
 	T lowpass()
 	{
 		return tmp;
@@ -128,6 +204,57 @@ struct TFourPole {
 		tmp4[3] = out;
 	}
 
+	/** Processes a block of n samples, writes the output of the given order, see lowpassN().
+	Same result as calling process() and lowpassN() per sample, but the state stays in registers.
+	`input` and `output` may be the same array.
+	*/
+	void processBlock(const T* input, T* output, int n, int order) {
+		switch (order)
+		{
+		case 0:
+			processBlock<0>(input, output, n);
+			break;
+		case 1:
+			processBlock<1>(input, output, n);
+			break;
+		case 2:
+			processBlock<2>(input, output, n);
+			break;
+		default:
+			processBlock<3>(input, output, n);
+			break;
+		}
+	}
+
+	template <int ORDER>
+	void processBlock(const T* input, T* output, int n) {
+		T s0 = tmp4[0];
+		T s1 = tmp4[1];
+		T s2 = tmp4[2];
+		T s3 = tmp4[3];
+		T gain = 1.f + q;
+
+		for (int i = 0; i < n; ++i)
+		{
+			// resonance
+			T x = input[i] - q * s3;
+			x = simd::clamp(x, -5.f, 5.f);
+
+			s0 = a*x - b*s0;
+			s1 = a*s0 - b*s1;
+			s2 = a*s1 - b*s2;
+			s3 = a*s2 - b*s3;
+
+			T tap = ORDER == 0 ? s0 : ORDER == 1 ? s1 : ORDER == 2 ? s2 : s3;
+			output[i] = clamp(tap * gain);
+		}
+
+		tmp4[0] = s0;
+		tmp4[1] = s1;
+		tmp4[2] = s2;
+		tmp4[3] = s3;
+	}
+
 	T lowpass()
 	{
 		return lowpass4();
@@ -224,6 +351,284 @@ struct TSVF {
 		bp = c * hp + bp;
 		//notch = hp + lp;
 	}
+
+	enum Output {
+		LOWPASS,
+		HIGHPASS,
+		BANDPASS
+	};
+
+	/** Processes a block of n samples, writes the lowpass output.
+	Same result as calling process() and lowpass() per sample, but the state stays in registers.
+	`input` and `output` may be the same array.
+	*/
+	void processBlockLowpass(const T* input, T* output, int n) {
+		processBlock<LOWPASS>(input, output, n);
+	}
+
+	void processBlockHighpass(const T* input, T* output, int n) {
+		processBlock<HIGHPASS>(input, output, n);
+	}
+
+	void processBlockBandpass(const T* input, T* output, int n) {
+		processBlock<BANDPASS>(input, output, n);
+	}
+
+	template <int OUTPUT>
+	void processBlock(const T* input, T* output, int n) {
+		T l = lp;
+		T h = hp;
+		T b = bp;
+
+		for (int i = 0; i < n; ++i)
+		{
+			l = l + c * b;
+			h = scale * input[i] - l - q * b;
+			b = c * h + b;
+			output[i] = OUTPUT == LOWPASS ? l : OUTPUT == HIGHPASS ? h : b;
+		}
+
+		lp = l;
+		hp = h;
+		bp = b;
+	}
+	T lowpass() {
+		return lp;
+	}
+	T highpass() {
+		return hp;
+	}
+	T bandpass() {
+		return bp;
+	}
+};
+
+
+/**
+ * tan(x) for x in [0, pi/2), Pade approximant on [0, pi/4], and tan(x) = 1 / tan(pi/2 - x) above.
+ * Relative error < 2e-8
+ * T is float or float_4.
+ */
+template <typename T>
+inline T tanFast(T x)
+{
+	auto upper = x > (float)(M_PI / 4.);
+	T y = simd::ifelse(upper, (float)(M_PI / 2.) - x, x);
+	T y2 = y * y;
+	T num = y * (945.f + y2 * (-105.f + y2));
+	T den = 945.f + y2 * (-420.f + 15.f * y2);
+	return simd::ifelse(upper, den / num, num / den);
+}
+
+
+/**
+ * 1 pole lowpass/highpass, zero delay feedback (topology preserving transform)
+ * The cutoff frequency is exact up to almost Nyquist.
+ */
+template <typename T = float>
+struct TOnePoleZDF {
+	T G = 0.f;
+	T in = 0.f;
+	T y = 0.f;
+	T s = 0.f;
+
+	TOnePoleZDF() {
+		reset();
+	}
+
+	void reset() {
+		in = 0.f;
+		y = 0.f;
+		s = 0.f;
+	}
+
+	/** Sets the cutoff frequency.
+	`f` is the ratio between the cutoff frequency and sample rate, i.e. f = f_c / f_s
+	*/
+	void setCutoffFreq(T f) {
+		T g = tanFast((float)M_PI * simd::fmin(simd::fmax(f, 0.f), 0.49f));
+		G = g / (1.f + g);
+	}
+
+	void process(T x) {
+		in = x;
+		T v = (x - s) * G;
+		y = v + s;
+		s = y + v;
+	}
+
+	T lowpass()
+	{
+		return y;
+	}
+
+	T highpass()
+	{
+		return in - y;
+	}
+};
+
+
+/**
+ * 4 pole lowpass, zero delay feedback (topology preserving transform)
+ * Same interface and resonance behavior as TFourPole, but the cutoff frequency is exact up to almost Nyquist,
+ * and the resonance does not detune at high cutoff frequencies.
+ */
+template <typename T = float>
+struct TFourPoleZDF {
+	T G = 0.f;
+	T q = 0.f;
+	T s[4];
+	T y[4];
+
+	TFourPoleZDF() {
+		reset();
+	}
+
+	void reset() {
+		for (int i=0; i<4; ++i)
+		{
+			s[i] = {0.f};
+			y[i] = {0.f};
+		}
+	}
+
+	/** Sets the cutoff frequency.
+	`f` is the ratio between the cutoff frequency and sample rate, i.e. f = f_c / f_s
+	*/
+	void setCutoffFreq(T f) {
+		T g = tanFast((float)M_PI * simd::fmin(simd::fmax(f, 0.f), 0.49f));
+		G = g / (1.f + g);
+	}
+
+	void setResonance(T res)
+	{
+		q = res;
+	}
+
+	void process(T x) {
+		// output of the last stage is G^4 * u + sigma, solve the feedback loop for the input u
+		T oneMinusG = 1.f - G;
+		T sigma = oneMinusG * s[3];
+		sigma += G * oneMinusG * s[2];
+		T G2 = G * G;
+		sigma += G2 * oneMinusG * s[1];
+		sigma += G2 * G * oneMinusG * s[0];
+
+		T u = (x - q * sigma) / (1.f + q * G2 * G2);
+		u = simd::clamp(u, -5.f, 5.f);
+
+		for (int i = 0; i < 4; ++i)
+		{
+			T v = (u - s[i]) * G;
+			y[i] = v + s[i];
+			s[i] = y[i] + v;
+			u = y[i];
+		}
+	}
+
+	T lowpass()
+	{
+		return lowpass4();
+	}
+
+	T lowpass1() {
+		return clamp(y[0] * (1.f + q));
+	}
+
+	T lowpass2() {
+		return clamp(y[1] * (1.f + q));
+	}
+
+	T lowpass3() {
+		return clamp(y[2] * (1.f + q));
+	}
+
+	T lowpass4() {
+		return clamp(y[3] * (1.f + q));
+	}
+
+	T lowpassN(int order) {
+		return clamp(y[order] * (1.f + q));
+	}
+
+	T clamp(T in)
+	{
+		return simd::clamp(in, -5.f, 5.f);
+	}
+};
+
+
+/**
+ * State variable filter, zero delay feedback (topology preserving transform)
+ * Same interface, resonance and gain as TSVF: the damping is q = 1 - r, and the input is scaled by q,
+ * so the lowpass gain at the cutoff frequency is 1 and the DC gain is q.
+ * But stable at all settings, and the cutoff frequency is exact up to almost Nyquist, TSVF is limited to 0.2.
+ */
+template <typename T = float>
+struct TSVFZDF {
+	T k = {1.f};
+	T scale = {1.f};
+	T a1 = {1.f};
+	T a2 = {0.f};
+	T a3 = {0.f};
+	T g = {0.f};
+
+	T ic1eq = {0.f};
+	T ic2eq = {0.f};
+
+	T lp = {0};
+	T hp = {0};
+	T bp = {0};
+
+	TSVFZDF() {
+		reset();
+	}
+
+	void reset() {
+		ic1eq = 0.f;
+		ic2eq = 0.f;
+		lp = 0.f;
+		hp = 0.f;
+		bp = 0.f;
+	}
+
+	/** Sets the cutoff frequency.
+	`f` is the ratio between the cutoff frequency and sample rate, i.e. f = f_c / f_s
+	*/
+	void setCutoffFreq(T f) {
+		g = tanFast((float)M_PI * simd::fmin(simd::fmax(f, 0.f), 0.49f));
+		updateCoefficients();
+	}
+
+	/**
+	 * Set resonance between 0 and 1
+	 */
+	void setResonance(T r) {
+		// damping, 1 is no resonance
+		k = simd::fmin(simd::fmax(1.f - r, 0.f), 1.f);
+		scale = k;
+		updateCoefficients();
+	}
+
+	void updateCoefficients() {
+		a1 = 1.f / (1.f + g * (g + k));
+		a2 = g * a1;
+		a3 = g * a2;
+	}
+
+	void process(T x) {
+		x *= scale;
+		T v3 = x - ic2eq;
+		T v1 = a1 * ic1eq + a2 * v3;
+		T v2 = ic2eq + a2 * ic1eq + a3 * v3;
+		ic1eq = 2.f * v1 - ic1eq;
+		ic2eq = 2.f * v2 - ic2eq;
+
+		lp = v2;
+		bp = v1;
+		hp = x - k * v1 - v2;
+	}
 	T lowpass() {
 		return lp;
 	}
@@ -1,3 +1,4 @@
+#pragma once
 #include <rack.hpp>
 
 namespace musx {
@@ -28,4 +29,214 @@ inline float_4 cheapSaturator(float_4 x)
 	return x - 1.f/675.f * x*x*x;
 }
 
+/**
+ * atan(x), range reduction and polynomial from Cephes atanf, error < 1e-7
+ */
+inline float_4 atanFast(float_4 x)
+{
+	float_4 a = simd::fabs(x);
+	float_4 big = a > 2.414213562f; // tan(3*pi/8)
+	float_4 mid = a > 0.414213562f; // tan(pi/8)
+
+	float_4 y = simd::ifelse(big, float_4(M_PI / 2), simd::ifelse(mid, float_4(M_PI / 4), 0.f));
+	a = simd::ifelse(big, -1.f / simd::fmax(a, 1.f), simd::ifelse(mid, (a - 1.f) / (a + 1.f), a));
+
+	float_4 z = a * a;
+	y += ((((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * a + a);
+	return simd::ifelse(x < 0.f, -y, y);
+}
+
+/**
+ * Two-point polyBLEP: adds the residual of a band-limited step of height h to the samples around the step.
+ * d is the time since the step, in sample periods (0 <= d < 1).
+ * previous is the sample before the step, so the signal must be delayed by one sample.
+ */
+inline void polyBlep(float_4 h, float_4 d, float_4& current, float_4& previous)
+{
+	float_4 e = 1.f - d;
+	current -= 0.5f * h * e * e;
+	previous += 0.5f * h * d * d;
+}
+
+
+/**
+ * Nonlinearities with their first and second antiderivatives F1 and F2, for ADAA1 and ADAA2.
+ * The antiderivatives are 0 at x = 0.
+ * The input is multiplied by inputScale() first, so the antiderivatives stay small and precise in single precision.
+ * tolerance() is the input difference below which the divided differences are ill-conditioned.
+ */
+
+/** musx::tanh */
+struct TanhAntiderivatives {
+	static float inputScale() { return 1.f; }
+	static float tolerance() { return 1e-2f; }
+
+	static float_4 f(float_4 x) {
+		return musx::tanh(x);
+	}
+
+	static float_4 F1(float_4 x) {
+		// x(27 + x²)/(27 + 9x²) = x/9 + 8/3 * x/(3 + x²)
+		float_4 a = simd::fmin(simd::fabs(x), 3.f);
+		float_4 F = a * a * (1.f / 18.f) + (4.f / 3.f) * simd::log(1.f + a * a * (1.f / 3.f));
+		// |y| = 1 above 3
+		return F + simd::fabs(x) - a;
+	}
+
+	static float_4 F2(float_4 x) {
+		float_4 a = simd::fmin(simd::fabs(x), 3.f);
+		float_4 F = a * a * a * (1.f / 54.f) + (4.f / 3.f) * (a * simd::log(1.f + a * a * (1.f / 3.f)) - 2.f * a + 3.464101615f * atanFast(a * 0.577350269f));
+		// F1(3) = 1/2 + 4/3 * log(4)
+		float_4 d = simd::fabs(x) - a;
+		F += 2.348392481f * d + 0.5f * d * d;
+		return simd::ifelse(x < 0.f, -F, F);
+	}
+};
+
+/** musx::cheapSaturator, with u = x / 15: y = 15u - 5u³ for |u| <= 1 */
+struct CheapSaturatorAntiderivatives {
+	static float inputScale() { return 1.f / 15.f; }
+	static float tolerance() { return 1e-2f; }
+
+	static float_4 f(float_4 u) {
+		u = simd::clamp(u, -1.f, 1.f);
+		return u * (15.f - 5.f * u * u);
+	}
+
+	static float_4 F1(float_4 u) {
+		float_4 a = simd::fmin(simd::fabs(u), 1.f);
+		float_4 F = a * a * (7.5f - 1.25f * a * a);
+		// |y| = 10 above 1
+		return F + 10.f * (simd::fabs(u) - a);
+	}
+
+	static float_4 F2(float_4 u) {
+		float_4 a = simd::fmin(simd::fabs(u), 1.f);
+		float_4 F = a * a * a * (2.5f - 0.25f * a * a);
+		// F1(1) = 6.25
+		float_4 d = simd::fabs(u) - a;
+		F += 6.25f * d + 5.f * d * d;
+		return simd::ifelse(u < 0.f, -F, F);
+	}
+};
+
+/** musx::waveshape */
+struct WaveshapeAntiderivatives {
+	static float inputScale() { return 1.f; }
+	static float tolerance() { return 1e-2f; }
+
+	static float_4 f(float_4 x) {
+		return musx::waveshape(x);
+	}
+
+	static float_4 F1(float_4 x) {
+		return x * (1.f / 8.f + x * (1.f / 2.f - x * (1.f / 24.f + x * (1.f / 72.f))));
+	}
+
+	static float_4 F2(float_4 x) {
+		return x * x * (1.f / 16.f + x * (1.f / 6.f - x * (1.f / 96.f + x * (1.f / 360.f))));
+	}
+};
+
+
+/**
+ * First order antiderivative anti-aliasing of a memoryless nonlinearity, see
+ * Parker, Zavalishin, Le Bivic: "Reducing the aliasing of nonlinear waveshaping using continuous-time convolution", DAFx 2016.
+ * The output is delayed by half a sample.
+ */
+template <typename NL>
+struct ADAA1 {
+	float_4 x1 = 0.f;
+	float_4 F1x1 = 0.f;
+
+	void reset() {
+		x1 = 0.f;
+		F1x1 = 0.f;
+	}
+
+	float_4 process(float_4 x) {
+		x *= NL::inputScale();
+		float_4 F1x = NL::F1(x);
+
+		float_4 dx = x - x1;
+		float_4 illConditioned = simd::fabs(dx) < NL::tolerance();
+		float_4 y = (F1x - F1x1) / simd::ifelse(illConditioned, 1.f, dx);
+		if (simd::movemask(illConditioned))
+		{
+			y = simd::ifelse(illConditioned, NL::f(0.5f * (x + x1)), y);
+		}
+
+		x1 = x;
+		F1x1 = F1x;
+		return y;
+	}
+};
+
+/**
+ * Second order antiderivative anti-aliasing of a memoryless nonlinearity, see
+ * Bilbao, Esqueda, Parker, Valimaki: "Antiderivative Antialiasing for Memoryless Nonlinearities", IEEE SPL 2017.
+ * The output is delayed by one sample.
+ */
+template <typename NL>
+struct ADAA2 {
+	float_4 x1 = 0.f;
+	float_4 x2 = 0.f;
+	float_4 F2x1 = 0.f;
+	float_4 d2 = 0.f; // divided difference of F2 between x1 and x2
+
+	void reset() {
+		x1 = 0.f;
+		x2 = 0.f;
+		F2x1 = 0.f;
+		d2 = 0.f;
+	}
+
+	float_4 process(float_4 x) {
+		// the second divided difference is worse conditioned than the first
+		const float tolerance = 3.f * NL::tolerance();
+
+		x *= NL::inputScale();
+		float_4 F2x = NL::F2(x);
+
+		// divided difference of F2 between x and x1
+		float_4 dx1 = x - x1;
+		float_4 illConditioned1 = simd::fabs(dx1) < tolerance;
+		float_4 d1 = (F2x - F2x1) / simd::ifelse(illConditioned1, 1.f, dx1);
+		if (simd::movemask(illConditioned1))
+		{
+			// mean of F1 between x1 and x, Simpson's rule
+			float_4 simpson = (NL::F1(x) + 4.f * NL::F1(0.5f * (x + x1)) + NL::F1(x1)) * (1.f / 6.f);
+			d1 = simd::ifelse(illConditioned1, simpson, d1);
+		}
+
+		float_4 dx2 = x - x2;
+		float_4 illConditioned2 = simd::fabs(dx2) < tolerance;
+		float_4 y = 2.f * (d1 - d2) / simd::ifelse(illConditioned2, 1.f, dx2);
+		if (simd::movemask(illConditioned2))
+		{
+			// x ~ x2: expand around the mean of x and x2
+			float_4 xBar = 0.5f * (x + x2);
+			float_4 delta = xBar - x1;
+			float_4 illConditioned3 = simd::fabs(delta) < tolerance;
+			delta = simd::ifelse(illConditioned3, 1.f, delta);
+			float_4 fallback = 2.f / delta * (NL::F1(xBar) + (F2x1 - NL::F2(xBar)) / delta);
+			fallback = simd::ifelse(illConditioned3, NL::f(0.5f * (xBar + x1)), fallback);
+			y = simd::ifelse(illConditioned2, fallback, y);
+		}
+
+		x2 = x1;
+		x1 = x;
+		F2x1 = F2x;
+		d2 = d1;
+		return y;
+	}
+};
+
+typedef ADAA1<TanhAntiderivatives> TanhADAA1;
+typedef ADAA2<TanhAntiderivatives> TanhADAA2;
+typedef ADAA1<CheapSaturatorAntiderivatives> CheapSaturatorADAA1;
+typedef ADAA2<CheapSaturatorAntiderivatives> CheapSaturatorADAA2;
+typedef ADAA1<WaveshapeAntiderivatives> WaveshapeADAA1;
+typedef ADAA2<WaveshapeAntiderivatives> WaveshapeADAA2;
+
 }
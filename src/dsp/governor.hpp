@@ -0,0 +1,209 @@
+#pragma once
+#include <rack.hpp>
+#include "commands.hpp"
+
+namespace musx {
+
+using namespace rack;
+
+/**
+ * Opt-in CPU governor for modules with a quality / CPU trade-off.
+ *
+ * begin() and end() enclose process(). The average time of process() is measured over a window of samples,
+ * as a fraction of the sample period. If it exceeds the budget, the level is stepped up (lower quality),
+ * if it stays well below the budget for some windows, the level is stepped down again.
+ * Level 0 is the quality set by the user, up to maxLevel.
+ * The module is responsible for switching levels without clicks, e.g. with a crossfade.
+ * The context menu pushes its settings to commands, begin() applies them.
+ */
+struct CpuGovernor {
+	bool enabled = false;
+	float budget = 0.02f; // fraction of the sample period
+	int maxLevel = 0;
+
+	static const int budgetsLen = 5;
+
+	// settings from the context menu, applied in begin()
+	enum CommandId {
+		SET_ENABLED,
+		SET_BUDGET // index, see getBudget()
+	};
+	CommandQueue<> commands;
+
+	int level = 0;
+	int targetLevel = 0;
+
+	float load = 0.f; // last measured fraction of the sample period
+
+	static const int windowLength = 4096; // [samples]
+	static const int headroomWindows = 8; // windows below the step up threshold before stepping up
+
+	double startTime = 0.;
+	double windowTime = 0.;
+	int windowCount = 0;
+	int headroomCount = 0;
+
+	/**
+	 * budgets of the context menu, 0.5% to 10%
+	 */
+	static float getBudget(int index)
+	{
+		static const float budgets[budgetsLen] = {0.005f, 0.01f, 0.02f, 0.05f, 0.1f};
+		return budgets[clamp(index, 0, budgetsLen - 1)];
+	}
+
+	/** budget from a patch, limited to the range of the context menu. NaN and infinity give the default budget */
+	void setBudget(float arg)
+	{
+		budget = std::isfinite(arg) ? clamp(arg, getBudget(0), getBudget(budgetsLen - 1)) : getBudget(2);
+	}
+
+	void applyCommand(const Command& command)
+	{
+		switch (command.id)
+		{
+			case SET_ENABLED:
+				setEnabled(command.value);
+				break;
+			case SET_BUDGET:
+				budget = getBudget(command.value);
+				break;
+		}
+	}
+
+	void begin()
+	{
+		Command command;
+		while (commands.pop(command))
+		{
+			applyCommand(command);
+		}
+
+		if (enabled)
+		{
+			startTime = system::getTime();
+		}
+	}
+
+	/**
+	 * returns true if level has changed, then the module applies the new level
+	 */
+	bool end(float sampleTime)
+	{
+		if (enabled)
+		{
+			windowTime += system::getTime() - startTime;
+			if (++windowCount >= windowLength)
+			{
+				load = windowTime / windowCount / sampleTime;
+				windowTime = 0.;
+				windowCount = 0;
+
+				if (load > budget)
+				{
+					targetLevel = std::min(level + 1, maxLevel);
+					headroomCount = 0;
+				}
+				// stepping down roughly doubles the load
+				else if (load < 0.4f * budget && ++headroomCount >= headroomWindows)
+				{
+					targetLevel = std::max(level - 1, 0);
+					headroomCount = 0;
+				}
+			}
+		}
+		else
+		{
+			targetLevel = 0;
+		}
+		targetLevel = std::min(targetLevel, maxLevel);
+
+		if (targetLevel == level)
+		{
+			return false;
+		}
+
+		level = targetLevel;
+
+		// the next window measures the new level only
+		windowTime = 0.;
+		windowCount = 0;
+		return true;
+	}
+
+	void setEnabled(bool arg)
+	{
+		enabled = arg;
+		windowTime = 0.;
+		windowCount = 0;
+		headroomCount = 0;
+		load = 0.f;
+	}
+
+	/**
+	 * for the tooltip, e.g. "CPU governor: 8x oversampling, load 1.2% of 2%"
+	 */
+	std::string getDescription(std::string setting)
+	{
+		if (!enabled)
+		{
+			return "";
+		}
+		return string::f("CPU governor: %s, load %.1f%% of %g%%", setting.c_str(), 100.f * load, 100.f * budget);
+	}
+};
+
+/**
+ * Port info that shows the decision of a CpuGovernor in the tooltip.
+ * getSetting returns the current setting of the governed parameter, e.g. "8x oversampling"
+ */
+struct CpuGovernorPortInfo : PortInfo {
+	CpuGovernor* governor = NULL;
+	std::function<std::string()> getSetting;
+
+	std::string getDescription() override {
+		std::string description = PortInfo::getDescription();
+		if (!governor || !governor->enabled)
+		{
+			return description;
+		}
+		if (!description.empty())
+		{
+			description += "\n";
+		}
+		return description + governor->getDescription(getSetting ? getSetting() : "");
+	}
+};
+
+/**
+ * Context menu items to enable the governor and to select its budget
+ */
+inline void appendCpuGovernorMenu(Menu* menu, CpuGovernor* governor)
+{
+	menu->addChild(createBoolMenuItem("CPU governor", "",
+		[=]() {
+			return governor->enabled;
+		},
+		[=](int mode) {
+			governor->commands.push(CpuGovernor::SET_ENABLED, mode);
+		}
+	));
+
+	menu->addChild(createIndexSubmenuItem("CPU governor budget", {"0.5%", "1%", "2%", "5%", "10%"},
+		[=]() {
+			for (int i = 0; i < CpuGovernor::budgetsLen; i++)
+			{
+				if (governor->budget <= CpuGovernor::getBudget(i))
+				{
+					return i;
+				}
+			}
+			return CpuGovernor::budgetsLen - 1;
+		},
+		[=](int mode) {
+			governor->commands.push(CpuGovernor::SET_BUDGET, mode);
+		}
+	));
+}
+
+}
@@ -0,0 +1,528 @@
+#include <rack.hpp>
+
+namespace musx {
+
+using namespace rack;
+using simd::float_4;
+
+/**
+ * Compiled coefficient matrix of a polyphonic modulation matrix.
+ *
+ * The coefficients are kept in a flat, aligned array. For each column, a list of the active rows
+ * (non-zero coefficient and connected input) is kept, so that the sparse kernel only multiplies active cells.
+ * The lists are only rebuilt for columns that changed.
+ * For densely populated matrices, a dense kernel loads each input once and accumulates into blocks of
+ * column accumulators, which stay in registers.
+ *
+ * Only dirty columns are calculated. A column becomes dirty when one of its coefficients changes, or when it
+ * depends on a row that changed (setRowDirty).
+ *
+ * Cells can be modulated by a depth value (setDepthIndex), which multiplies the coefficient.
+ * The modulated cells of each column are kept in a separate list, their effective coefficients are updated by setDepth.
+ */
+template <int ROWS, int COLUMNS>
+struct CoefficientMatrix {
+	// 8 accumulators + input + coefficient fit into the 16 SSE registers
+	static constexpr int blockSize = 8;
+	static_assert(COLUMNS % blockSize == 0, "COLUMNS must be a multiple of 8");
+
+	alignas(16) float coeffs[ROWS][COLUMNS] = {};
+	// coefficients without the modulated cells and the rows of disconnected inputs, for the dense kernel
+	alignas(16) float denseCoeffs[ROWS][COLUMNS] = {};
+
+	// 0: cell is not modulated, else index + 1 of its depth value
+	int depthIndex[ROWS][COLUMNS] = {};
+
+	bool rowActive[ROWS] = {};
+	bool columnActive[COLUMNS] = {};
+
+	// per column lists of active rows, and their coefficients
+	int numActiveRows[COLUMNS] = {};
+	int activeRows[COLUMNS][ROWS] = {};
+	float activeCoeffs[COLUMNS][ROWS] = {};
+
+	// per column lists of active modulated rows, their depth indices, coefficients, and modulated coefficients
+	int numModRows[COLUMNS] = {};
+	int modRows[COLUMNS][ROWS] = {};
+	int modDepth[COLUMNS][ROWS] = {};
+	float modBase[COLUMNS][ROWS] = {};
+	float modCoeffs[COLUMNS][ROWS] = {};
+
+	// the dense kernel runs over the rows up to the last connected one
+	int denseRows = 0;
+
+	bool useDense = false;
+
+	bool columnChanged[COLUMNS] = {};
+	bool changed = false;
+
+	// columns which must be recalculated
+	bool columnDirty[COLUMNS] = {};
+
+	void setCoeff(int row, int column, float value)
+	{
+		if (coeffs[row][column] != value)
+		{
+			coeffs[row][column] = value;
+			columnChanged[column] = true;
+			columnDirty[column] = true;
+			changed = true;
+		}
+	}
+
+	void setDepthIndex(int row, int column, int index)
+	{
+		if (depthIndex[row][column] != index)
+		{
+			depthIndex[row][column] = index;
+			columnChanged[column] = true;
+			columnDirty[column] = true;
+			changed = true;
+		}
+	}
+
+	/** update the coefficients of the modulated cells, mark columns with changed coefficients */
+	void setDepth(const float* depth)
+	{
+		for (int j = 0; j < COLUMNS; j++)
+		{
+			for (int k = 0; k < numModRows[j]; k++)
+			{
+				float value = modBase[j][k] * depth[modDepth[j][k]];
+				if (value != modCoeffs[j][k])
+				{
+					modCoeffs[j][k] = value;
+					columnDirty[j] = true;
+				}
+			}
+		}
+	}
+
+	/** the input of a row changed, mark all columns which depend on it */
+	void setRowDirty(int row)
+	{
+		if (!rowActive[row])
+		{
+			return;
+		}
+		for (int j = 0; j < COLUMNS; j++)
+		{
+			columnDirty[j] |= coeffs[row][j] != 0.f;
+		}
+	}
+
+	void setColumnDirty(int column)
+	{
+		columnDirty[column] = true;
+	}
+
+	void setAllDirty()
+	{
+		for (int j = 0; j < COLUMNS; j++)
+		{
+			columnDirty[j] = true;
+		}
+	}
+
+	/** rebuild the lists of all columns in the next compile(), and calculate all columns */
+	void invalidate()
+	{
+		for (int j = 0; j < COLUMNS; j++)
+		{
+			columnChanged[j] = true;
+			columnDirty[j] = true;
+		}
+		changed = true;
+	}
+
+	void clearDirty()
+	{
+		for (int j = 0; j < COLUMNS; j++)
+		{
+			columnDirty[j] = false;
+		}
+	}
+
+	/** true if the column is connected and must be recalculated */
+	inline bool columnNeedsUpdate(int column) const
+	{
+		return columnActive[column] && columnDirty[column];
+	}
+
+	/** row is active when its input is connected */
+	void setRowActive(int row, bool active)
+	{
+		if (rowActive[row] != active)
+		{
+			rowActive[row] = active;
+			for (int j = 0; j < COLUMNS; j++)
+			{
+				columnChanged[j] = true;
+				columnDirty[j] = true;
+			}
+			changed = true;
+		}
+	}
+
+	/** column is active when its output is connected */
+	void setColumnActive(int column, bool active)
+	{
+		if (columnActive[column] != active)
+		{
+			columnActive[column] = active;
+			columnDirty[column] = true;
+			changed = true;
+		}
+	}
+
+	/** rebuild the lists of active rows for all changed columns */
+	void compile()
+	{
+		if (!changed)
+		{
+			return;
+		}
+
+		for (int j = 0; j < COLUMNS; j++)
+		{
+			if (!columnChanged[j])
+			{
+				continue;
+			}
+
+			numActiveRows[j] = 0;
+			numModRows[j] = 0;
+			for (int i = 0; i < ROWS; i++)
+			{
+				bool modulated = depthIndex[i][j];
+				denseCoeffs[i][j] = modulated || !rowActive[i] ? 0.f : coeffs[i][j];
+
+				if (!rowActive[i] || coeffs[i][j] == 0.f)
+				{
+					continue;
+				}
+
+				if (modulated)
+				{
+					int k = numModRows[j]++;
+					modRows[j][k] = i;
+					modDepth[j][k] = depthIndex[i][j] - 1;
+					modBase[j][k] = coeffs[i][j];
+					modCoeffs[j][k] = 0.f; // set by setDepth
+				}
+				else
+				{
+					int k = numActiveRows[j]++;
+					activeRows[j][k] = i;
+					activeCoeffs[j][k] = coeffs[i][j];
+				}
+			}
+			columnChanged[j] = false;
+		}
+
+		denseRows = 0;
+		for (int i = 0; i < ROWS; i++)
+		{
+			if (rowActive[i])
+			{
+				denseRows = i + 1;
+			}
+		}
+
+		// choose kernel: the sparse kernel costs about twice as much per cell
+		int sparseCells = 0;
+		int denseCells = 0;
+		for (int j0 = 0; j0 < COLUMNS; j0 += blockSize)
+		{
+			bool blockActive = false;
+			for (int j = j0; j < j0 + blockSize; j++)
+			{
+				if (columnActive[j])
+				{
+					sparseCells += numActiveRows[j];
+					blockActive = true;
+				}
+			}
+			denseCells += blockActive * blockSize * denseRows;
+		}
+		useDense = 2 * sparseCells > denseCells;
+
+		changed = false;
+	}
+
+	/**
+	 * Multiply one group of 4 channels.
+	 * `in` holds ROWS input values, `out` holds COLUMNS output values, which are added to.
+	 * The inputs of inactive rows must be finite, the dense kernel multiplies them by 0.
+	 * Only active and dirty columns are calculated.
+	 */
+	inline void process(const float_4* in, float_4* out) const
+	{
+		if (useDense)
+		{
+			processDense(in, out);
+		}
+		else
+		{
+			processSparse(in, out);
+		}
+	}
+
+	/** add the modulated cells of a column */
+	inline float_4 processModulated(int column, const float_4* in, float_4 acc) const
+	{
+		for (int k = 0; k < numModRows[column]; k++)
+		{
+			acc += in[modRows[column][k]] * modCoeffs[column][k];
+		}
+		return acc;
+	}
+
+	void processSparse(const float_4* in, float_4* out) const
+	{
+		for (int j = 0; j < COLUMNS; j++)
+		{
+			if (!columnNeedsUpdate(j))
+			{
+				continue;
+			}
+
+			float_4 acc = out[j];
+			for (int k = 0; k < numActiveRows[j]; k++)
+			{
+				acc += in[activeRows[j][k]] * activeCoeffs[j][k];
+			}
+			out[j] = processModulated(j, in, acc);
+		}
+	}
+
+	/**
+	 * Multiply a block of n samples of one group of 4 channels.
+	 * `in` holds n * ROWS input values, `out` holds n * COLUMNS output values, which are added to.
+	 * All active columns are calculated. Each coefficient is loaded once per block, and the accumulators of one
+	 * column are kept in a local buffer of at most MAXBLOCK samples.
+	 */
+	template <int MAXBLOCK>
+	void processBlock(const float_4* in, float_4* out, int n) const
+	{
+		for (int j = 0; j < COLUMNS; j++)
+		{
+			if (!columnActive[j])
+			{
+				continue;
+			}
+
+			float_4 acc[MAXBLOCK];
+			for (int b = 0; b < n; b++)
+			{
+				acc[b] = out[b*COLUMNS + j];
+			}
+
+			for (int k = 0; k < numActiveRows[j]; k++)
+			{
+				const float_4* x = in + activeRows[j][k];
+				float_4 coeff = activeCoeffs[j][k];
+				for (int b = 0; b < n; b++)
+				{
+					acc[b] += x[b*ROWS] * coeff;
+				}
+			}
+			for (int k = 0; k < numModRows[j]; k++)
+			{
+				const float_4* x = in + modRows[j][k];
+				float_4 coeff = modCoeffs[j][k];
+				for (int b = 0; b < n; b++)
+				{
+					acc[b] += x[b*ROWS] * coeff;
+				}
+			}
+
+			for (int b = 0; b < n; b++)
+			{
+				out[b*COLUMNS + j] = acc[b];
+			}
+		}
+	}
+
+	void processDense(const float_4* in, float_4* out) const
+	{
+		for (int j0 = 0; j0 < COLUMNS; j0 += blockSize)
+		{
+			bool blockActive = false;
+			for (int j = j0; j < j0 + blockSize; j++)
+			{
+				blockActive |= columnNeedsUpdate(j);
+			}
+			if (!blockActive)
+			{
+				continue;
+			}
+
+			float_4 acc[blockSize];
+			for (int k = 0; k < blockSize; k++)
+			{
+				acc[k] = out[j0 + k];
+			}
+
+			// load each input once, accumulate into all columns of the block
+			for (int i = 0; i < denseRows; i++)
+			{
+				float_4 x = in[i];
+				for (int k = 0; k < blockSize; k++)
+				{
+					acc[k] += x * denseCoeffs[i][j0 + k];
+				}
+			}
+
+			for (int k = 0; k < blockSize; k++)
+			{
+				out[j0 + k] = processModulated(j0 + k, in, acc[k]);
+			}
+		}
+	}
+};
+
+
+/**
+ * Linear ramps for the coefficients of a CoefficientMatrix, to avoid zipper noise when coefficients change.
+ * Each change of a target value is ramped over a fixed number of steps.
+ */
+template <int ROWS, int COLUMNS>
+struct CoefficientRamps {
+	float targets[ROWS][COLUMNS] = {};
+	float incs[ROWS][COLUMNS] = {};
+	int steps[ROWS][COLUMNS] = {};
+
+	int rampSteps = 1;
+	int numRamping = 0;
+	int rowRamping[ROWS] = {};
+
+	void setRampSteps(int n)
+	{
+		rampSteps = std::max(n, 1);
+	}
+
+	void setTarget(int row, int column, float value, const CoefficientMatrix<ROWS, COLUMNS>& matrix)
+	{
+		if (targets[row][column] == value)
+		{
+			return;
+		}
+
+		targets[row][column] = value;
+		incs[row][column] = (value - matrix.coeffs[row][column]) / rampSteps;
+		if (!steps[row][column])
+		{
+			numRamping++;
+			rowRamping[row]++;
+		}
+		steps[row][column] = rampSteps;
+	}
+
+	/** end all ramps, the coefficients jump to their targets */
+	void reset(CoefficientMatrix<ROWS, COLUMNS>& matrix)
+	{
+		for (int i = 0; i < ROWS && numRamping; i++)
+		{
+			if (!rowRamping[i])
+			{
+				continue;
+			}
+
+			for (int j = 0; j < COLUMNS; j++)
+			{
+				if (steps[i][j])
+				{
+					matrix.setCoeff(i, j, targets[i][j]);
+					steps[i][j] = 0;
+					numRamping--;
+				}
+			}
+			rowRamping[i] = 0;
+		}
+	}
+
+	/** advance all ramps by one step */
+	void process(CoefficientMatrix<ROWS, COLUMNS>& matrix)
+	{
+		if (!numRamping)
+		{
+			return;
+		}
+
+		for (int i = 0; i < ROWS; i++)
+		{
+			if (!rowRamping[i])
+			{
+				continue;
+			}
+
+			for (int j = 0; j < COLUMNS; j++)
+			{
+				if (!steps[i][j])
+				{
+					continue;
+				}
+
+				if (--steps[i][j])
+				{
+					matrix.setCoeff(i, j, matrix.coeffs[i][j] + incs[i][j]);
+				}
+				else
+				{
+					matrix.setCoeff(i, j, targets[i][j]);
+					numRamping--;
+					rowRamping[i]--;
+				}
+			}
+		}
+	}
+};
+
+
+/**
+ * Stored coefficient scenes of a matrix, in one contiguous array.
+ * Adjacent scenes are interpolated with one vectorized linear interpolation over all cells.
+ */
+template <int ROWS, int COLUMNS, int SCENES>
+struct CoefficientScenes {
+	static constexpr int size = ROWS * COLUMNS;
+	static_assert(size % 4 == 0, "ROWS * COLUMNS must be a multiple of 4");
+	static_assert(SCENES >= 2, "at least 2 scenes are required");
+
+	alignas(16) float scenes[SCENES][ROWS][COLUMNS] = {};
+	alignas(16) float morphed[ROWS][COLUMNS] = {};
+
+	float position = -1.f;
+
+	void setCoeff(int scene, int row, int column, float value)
+	{
+		scenes[scene][row][column] = value;
+		position = -1.f;
+	}
+
+	/** interpolate between adjacent scenes. `pos` is in [0, SCENES - 1] */
+	void morph(float pos)
+	{
+		if (pos == position)
+		{
+			return;
+		}
+		position = pos;
+
+		int k = std::min(std::max((int)pos, 0), SCENES - 2);
+		float_4 t = pos - k;
+
+		const float* a = &scenes[k][0][0];
+		const float* b = &scenes[k+1][0][0];
+		float* out = &morphed[0][0];
+		for (int n = 0; n < size; n += 4)
+		{
+			float_4 x = float_4::load(a + n);
+			float_4 y = float_4::load(b + n);
+			(x + t * (y - x)).store(out + n);
+		}
+	}
+};
+
+}
@@ -0,0 +1,137 @@
+#include <rack.hpp>
+
+namespace musx {
+
+using namespace rack;
+using simd::float_4;
+using simd::int32_4;
+
+/**
+ * xorshift32 random number generator with 4 independent streams
+ */
+struct RandomGenerator4 {
+	int32_4 state = 1;
+
+	RandomGenerator4() {
+		seed();
+	}
+
+	void seed() {
+		for (int i = 0; i < 4; ++i)
+		{
+			// state must not be 0
+			state[i] = rack::random::u32() | 1;
+		}
+	}
+
+	/** uniformly distributed in [-0.5, 0.5) */
+	inline float_4 uniform() {
+		__m128i x = state.v;
+		x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+		x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+		x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+		state = int32_4(x);
+
+		// upper 23 bits as mantissa of a float in [1, 2)
+		__m128i mantissa = _mm_or_si128(_mm_srli_epi32(x, 9), _mm_set1_epi32(0x3f800000));
+		return float_4(_mm_castsi128_ps(mantissa)) - 1.5f;
+	}
+};
+
+
+/**
+ * Voss-McCartney pink (1/f) noise for 16 channels, with unit variance.
+ * The generator is clocked by calling process(). The spectrum is 1/f over ROWS octaves below the clock rate,
+ * the level does not depend on the clock rate.
+ */
+template <int ROWS = 8>
+struct PinkNoise16 {
+	RandomGenerator4 rng[4];
+	float_4 rows[ROWS][4];
+	uint32_t counter = 0;
+
+	// variance of the sum of ROWS + 1 uniform values in [-0.5, 0.5) is (ROWS + 1) / 12
+	const float scale = std::sqrt(12.f / (ROWS + 1));
+
+	PinkNoise16() {
+		reset();
+	}
+
+	void reset() {
+		counter = 0;
+		for (int i = 0; i < ROWS; ++i)
+		{
+			for (int g = 0; g < 4; ++g)
+			{
+				rows[i][g] = rng[g].uniform();
+			}
+		}
+	}
+
+	void process(float_4* out) {
+		// row i is updated every 2^(i+1) calls
+		counter = (counter + 1) & ((1 << ROWS) - 1);
+		if (counter)
+		{
+			int i = __builtin_ctz(counter);
+			for (int g = 0; g < 4; ++g)
+			{
+				rows[i][g] = rng[g].uniform();
+			}
+		}
+
+		for (int g = 0; g < 4; ++g)
+		{
+			float_4 sum = rng[g].uniform(); // white row
+			for (int i = 0; i < ROWS; ++i)
+			{
+				sum += rows[i][g];
+			}
+			out[g] = scale * sum;
+		}
+	}
+};
+
+
+/**
+ * Brown (1/f²) noise for 16 channels: white noise through a one-pole lowpass.
+ * The output has unit variance for any cutoff frequency.
+ */
+struct BrownNoise16 {
+	RandomGenerator4 rng[4];
+	float a = 0.f;
+	float gain = 0.f;
+	float_4 tmp[4];
+
+	BrownNoise16() {
+		setCutoffFreq(0.f);
+		reset();
+	}
+
+	void reset() {
+		for (int g = 0; g < 4; ++g)
+		{
+			tmp[g] = std::sqrt(12.f) * rng[g].uniform();
+		}
+	}
+
+	/** Sets the cutoff frequency.
+	`f` is the ratio between the cutoff frequency and sample rate, i.e. f = f_c / f_s
+	*/
+	void setCutoffFreq(float f) {
+		f = std::fmin(f, 0.3f);
+		a = std::exp(-2.f * M_PI * f);
+		// y = a*y + gain*x has variance gain² / (1 - a²) * var(x), with var(x) = 1/12
+		gain = std::sqrt(12.f * (1.f - a * a));
+	}
+
+	void process(float_4* out) {
+		for (int g = 0; g < 4; ++g)
+		{
+			tmp[g] = a * tmp[g] + gain * rng[g].uniform();
+			out[g] = tmp[g];
+		}
+	}
+};
+
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <rack.hpp>
+#include "functions.hpp"
+
+namespace musx {
+
+using namespace rack;
+using simd::float_4;
+using simd::int32_4;
+
+/**
+ * CV modulated parameters of the Oscillators module, for a group of voices, or of a group of unison copies
+ */
+struct OscillatorParameters {
+	float_4 osc1Shape = 0.f;
+	float_4 osc1PW = 0.f;
+	float_4 osc1Vol = 0.f;
+	float_4 osc1Subvol = 0.f;
+
+	float_4 osc2Shape = 0.f;
+	float_4 osc2PW = 0.f;
+	float_4 osc2Vol = 0.f;
+
+	float_4 fm = 0.f;
+	float_4 ringmod = 0.f;
+	int32_4 sync = 0;
+
+	float_4 voct1 = 0.f;
+	float_4 voct2 = 0.f;
+};
+
+/**
+ * waveform of an oscillator, +-INT32_MAX
+ * triangle for triAmt = 2, saw for sawSqAmt = 1, pulse for sawSqAmt = 1 and sqAmt = 1
+ */
+inline float_4 oscillatorWaveform(int32_4 phasor, int32_4 phaseOffset, float_4 triAmt, float_4 sawSqAmt, float_4 sqAmt)
+{
+	int32_4 phasorOffset = phasor + phaseOffset;
+	float_4 wave = triAmt * ((1.f*phasorOffset + (phasorOffset > 0) * 2.f * phasorOffset) + INT32_MAX/2);
+	wave += sawSqAmt * (phasorOffset * sqAmt - 1.f * phasor);
+	return wave;
+}
+
+/**
+ * Inner loop of the Oscillators module, see also tests/oscillators_benchmark.cpp
+ * n oversampled samples of the oscillators and their mix for a group of 4 voices, specialized for sync, FM and ring modulator on/off.
+ * phasor1Sub, phasor2 and mixDelay are the state of the group, the mix is delayed by one sample for the polyBLEP.
+ * The output is written to out, +-5V per oscillator.
+ */
+template<bool SYNC, bool FM, bool RINGMOD>
+inline void processOscillators(const OscillatorParameters& p, int32_4& phasor1Sub, int32_4& phasor2, float_4& mixDelay,
+		int32_4 phase1SubInc, int32_4 phase2Inc, float_4 fmAmt, float_4* out, int n)
+{
+	int32_4 phase1Inc = phase1SubInc + phase1SubInc;
+	float_4 tri1Amt = 2.f * simd::fmax(-p.osc1Shape, 0.f);  // [2, 0, 0]
+	float_4 sawSq1Amt = simd::fmin(1.f + p.osc1Shape, 1.f); // [0, 1, 1]
+	float_4 sq1Amt = simd::fmax(p.osc1Shape, 0.f);          // [0, 0, 1]
+	int32_4 phase1Offset = simd::ifelse(p.osc1PW < 0, (-1.f - p.osc1PW) * INT32_MAX, (1.f - p.osc1PW) * INT32_MAX); // for pulse wave = saw + inverted saw with phaseshift
+
+	float_4 tri2Amt = 2.f * simd::fmax(-p.osc2Shape, 0.f);
+	float_4 sawSq2Amt = simd::fmin(1.f + p.osc2Shape, 1.f);
+	float_4 sq2Amt = simd::fmax(p.osc2Shape, 0.f);
+	int32_4 phase2Offset = simd::ifelse(p.osc2PW < 0, (-1.f - p.osc2PW) * INT32_MAX, (1.f - p.osc2PW) * INT32_MAX); // for pulse wave
+
+	// steps of osc 2 when its phasor wraps, and at the pulse edge
+	float_4 wrapStep2 = 4294967296.f * sawSq2Amt;
+	float_4 edgeStep2 = -4294967296.f * sawSq2Amt * sq2Amt;
+
+	int32_4 syncMask = p.sync > 0;
+
+	for (int i = 0; i < n; ++i)
+	{
+		// phasors for subosc 1 and osc 1
+		phasor1Sub += phase1SubInc;
+		int32_4 phasor1 = phasor1Sub + phasor1Sub;
+
+		// osc 1 waveform
+		float_4 wave1 = oscillatorWaveform(phasor1, phase1Offset, tri1Amt, sawSq1Amt, sq1Amt); // +-INT32_MAX
+
+		// osc 1 suboscillator
+		float_4 sub1 = 1.f * (phasor1Sub + INT32_MAX) - 1.f * phasor1Sub; // +-INT32_MAX
+
+		// phasor for osc 2
+		int32_4 prevPhasor2 = phasor2;
+		int32_4 phase2Step = phase2Inc;
+		if (FM)
+		{
+			phase2Step += int32_4(fmAmt * wave1);
+		}
+		phasor2 += phase2Step;
+
+		// band-limited steps of osc 2, added to this and the delayed sample
+		float_4 blep = 0.f;
+		float_4 prevBlep = 0.f;
+
+		// sync: restart osc 2 at the sub-sample position where phasor 1 has wrapped
+		int32_4 synced = 0;
+		if (SYNC)
+		{
+			synced = syncMask & (phasor1 - phase1Inc > phasor1);
+			if (simd::movemask(synced))
+			{
+				float_4 d = (1.f * phasor1 + 2147483648.f) / (1.f * phase1Inc); // time since the wrap
+				int32_4 elapsed = d * (1.f * phase2Step);
+				int32_4 restart = INT32_MIN;
+				float_4 h = oscillatorWaveform(restart, phase2Offset, tri2Amt, sawSq2Amt, sq2Amt) - oscillatorWaveform(phasor2 - elapsed, phase2Offset, tri2Amt, sawSq2Amt, sq2Amt);
+				musx::polyBlep(float_4::cast(synced) & h, float_4::cast(synced) & d, blep, prevBlep);
+				phasor2 = simd::ifelse(synced, restart + elapsed, phasor2);
+			}
+		}
+
+		// osc 2 wrap and pulse edge, forward only
+		int32_4 forward = (phase2Step > 0) & ~synced;
+		int32_4 phasor2Offset = phasor2 + phase2Offset;
+		int32_4 wrapped = forward & (phasor2 < prevPhasor2);
+		int32_4 edge = forward & (phasor2Offset < prevPhasor2 + phase2Offset);
+		if (simd::movemask(wrapped | edge))
+		{
+			float_4 step = 1.f / (1.f * phase2Step);
+			float_4 d = (1.f * phasor2 + 2147483648.f) * step;
+			musx::polyBlep(float_4::cast(wrapped) & wrapStep2, float_4::cast(wrapped) & d, blep, prevBlep);
+			d = (1.f * phasor2Offset + 2147483648.f) * step;
+			musx::polyBlep(float_4::cast(edge) & edgeStep2, float_4::cast(edge) & d, blep, prevBlep);
+		}
+
+		// osc 2 waveform
+		float_4 wave2 = oscillatorWaveform(phasor2, phase2Offset, tri2Amt, sawSq2Amt, sq2Amt); // +-INT32_MAX
+
+		// mix
+		float_4 mix = p.osc1Subvol * sub1 + p.osc1Vol * wave1 + p.osc2Vol * wave2; // +-5V each
+		float_4 blepAmt = p.osc2Vol;
+		if (RINGMOD)
+		{
+			mix += p.ringmod * wave1 * wave2;
+			blepAmt += p.ringmod * wave1;
+		}
+
+		// one sample delay for the polyBLEP
+		out[i] = mixDelay + blepAmt * prevBlep;
+		mixDelay = mix + blepAmt * blep;
+	}
+}
+
+}
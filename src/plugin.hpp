@@ -12,6 +12,7 @@ namespace musx {
 extern Model* modelADSR;
 extern Model* modelDelay;
 extern Model* modelDrift;
+extern Model* modelFilter;
 extern Model* modelLast;
 extern Model* modelLFO;
 extern Model* modelModMatrix;
@@ -0,0 +1,286 @@
+#include "dsp/filters.hpp"
+#include <cstdio>
+
+/**
+ * Test of the block processing of TOnePole, TFourPole and TSVF: processBlock* must give the same output as
+ * process() and the output getter per sample, sample by sample, also across blocks of varying length and in place.
+ *
+ * Test of the zero delay feedback filters TOnePoleZDF, TFourPoleZDF and TSVFZDF: the gain at the cutoff frequency
+ * must match the analog prototype up to 0.45 f_s, and the filters must stay stable and bounded at full resonance.
+ */
+
+using namespace musx;
+
+static const int samples = 4096;
+static const int blockSizes[] = {1, 7, 32, 0, 64, 3, 128};
+
+static int failures = 0;
+
+static float input(int n)
+{
+	// saw plus a bit of noise, large enough to hit the clamping of the four pole filter
+	uint32_t random = n * 1664525u + 1013904223u;
+	return 8.f * ((n % 97) / 97.f - 0.5f) + ((random >> 8) & 0xffff) / 65536.f - 0.5f;
+}
+
+static float lane(float x, int)
+{
+	return x;
+}
+
+static float lane(float_4 x, int i)
+{
+	return x[i];
+}
+
+static int lanes(float)
+{
+	return 1;
+}
+
+static int lanes(float_4)
+{
+	return 4;
+}
+
+/** compares the reference and block output sample by sample, prints the first mismatch */
+template <typename T>
+static void compare(const char* name, const T* reference, const T* block)
+{
+	for (int n = 0; n < samples; n++)
+	{
+		for (int i = 0; i < lanes(T()); i++)
+		{
+			if (lane(reference[n], i) != lane(block[n], i))
+			{
+				std::printf("FAIL %s: sample %d, channel %d: per sample %.9g, block %.9g\n", name, n, i, lane(reference[n], i), lane(block[n], i));
+				failures++;
+				return;
+			}
+		}
+	}
+	std::printf("ok   %s\n", name);
+}
+
+/** per sample reference, output is the getter of the filter output */
+template <typename Filter, typename T, typename Output>
+static void processPerSample(Filter filter, const T* in, T* out, Output output)
+{
+	for (int n = 0; n < samples; n++)
+	{
+		filter.process(in[n]);
+		out[n] = output(filter);
+	}
+}
+
+/** blocks of varying length, in place */
+template <typename Filter, typename T, typename Block>
+static void processBlocks(Filter filter, const T* in, T* out, Block block)
+{
+	for (int n = 0; n < samples; n++)
+	{
+		out[n] = in[n];
+	}
+	int n = 0;
+	int b = 0;
+	while (n < samples)
+	{
+		int size = std::min(blockSizes[b++ % (sizeof(blockSizes) / sizeof(blockSizes[0]))], samples - n);
+		block(filter, out + n, out + n, size);
+		n += size;
+	}
+}
+
+template <typename T>
+static void testOnePole(const char* type, T cutoff)
+{
+	T in[samples];
+	T reference[samples];
+	T block[samples];
+	for (int n = 0; n < samples; n++)
+	{
+		in[n] = T(input(n));
+	}
+
+	TOnePole<T> filter;
+	filter.setCutoffFreq(cutoff);
+	char name[64];
+
+	processPerSample(filter, in, reference, [](TOnePole<T>& f) { return f.lowpass(); });
+	processBlocks(filter, in, block, [](TOnePole<T>& f, const T* i, T* o, int n) { f.processBlockLowpass(i, o, n); });
+	std::snprintf(name, sizeof(name), "TOnePole<%s> lowpass", type);
+	compare(name, reference, block);
+
+	processPerSample(filter, in, reference, [](TOnePole<T>& f) { return f.highpass(); });
+	processBlocks(filter, in, block, [](TOnePole<T>& f, const T* i, T* o, int n) { f.processBlockHighpass(i, o, n); });
+	std::snprintf(name, sizeof(name), "TOnePole<%s> highpass", type);
+	compare(name, reference, block);
+}
+
+static void testFourPole()
+{
+	float_4 in[samples];
+	float_4 reference[samples];
+	float_4 block[samples];
+	for (int n = 0; n < samples; n++)
+	{
+		in[n] = float_4(input(n), -input(n), 0.5f * input(n + 11), input(n + 23));
+	}
+
+	TFourPole<float_4> filter;
+	filter.setCutoffFreq(float_4(0.001f, 0.02f, 0.1f, 0.3f));
+	filter.setResonance(float_4(0.f, 1.f, 2.5f, 3.9f));
+
+	for (int order = 0; order < 4; order++)
+	{
+		processPerSample(filter, in, reference, [order](TFourPole<float_4>& f) { return f.lowpassN(order); });
+		processBlocks(filter, in, block, [order](TFourPole<float_4>& f, const float_4* i, float_4* o, int n) { f.processBlock(i, o, n, order); });
+		char name[64];
+		std::snprintf(name, sizeof(name), "TFourPole<float_4> order %d", order + 1);
+		compare(name, reference, block);
+	}
+}
+
+static void testSVF()
+{
+	float_4 in[samples];
+	float_4 reference[samples];
+	float_4 block[samples];
+	for (int n = 0; n < samples; n++)
+	{
+		in[n] = float_4(input(n), -input(n), 0.5f * input(n + 11), input(n + 23));
+	}
+
+	TSVF<float_4> filter;
+	filter.setCutoffFreq(float_4(0.001f, 0.02f, 0.1f, 0.2f));
+	filter.setResonance(float_4(0.f, 0.5f, 0.9f, 1.f));
+
+	processPerSample(filter, in, reference, [](TSVF<float_4>& f) { return f.lowpass(); });
+	processBlocks(filter, in, block, [](TSVF<float_4>& f, const float_4* i, float_4* o, int n) { f.processBlockLowpass(i, o, n); });
+	compare("TSVF<float_4> lowpass", reference, block);
+
+	processPerSample(filter, in, reference, [](TSVF<float_4>& f) { return f.highpass(); });
+	processBlocks(filter, in, block, [](TSVF<float_4>& f, const float_4* i, float_4* o, int n) { f.processBlockHighpass(i, o, n); });
+	compare("TSVF<float_4> highpass", reference, block);
+
+	processPerSample(filter, in, reference, [](TSVF<float_4>& f) { return f.bandpass(); });
+	processBlocks(filter, in, block, [](TSVF<float_4>& f, const float_4* i, float_4* o, int n) { f.processBlockBandpass(i, o, n); });
+	compare("TSVF<float_4> bandpass", reference, block);
+}
+
+/** gain of a filter in dB at the frequencies f of the lanes, measured with a sine after the filter settled */
+template <typename Filter, typename Output>
+static float_4 measureGain(Filter filter, float_4 f, Output output)
+{
+	const int settle = 1 << 14;
+	const int measure = 1 << 16;
+	float_4 power = 0.f;
+	float_4 phase = 0.f;
+	for (int n = 0; n < settle + measure; n++)
+	{
+		filter.process(simd::sin(2.f * (float)M_PI * phase));
+		phase += f;
+		phase -= simd::floor(phase);
+		float_4 y = output(filter);
+		if (n >= settle)
+		{
+			power += y * y;
+		}
+	}
+	// the power of a sine of amplitude 1 is 1/2
+	return 10.f * simd::log10(2.f * power / (float)measure);
+}
+
+/** compares the gain at the cutoff frequencies with the expected gain */
+static void compareGain(const char* name, float_4 cutoff, float_4 gain, float expected)
+{
+	static const float tolerance = 0.1f; // dB
+	for (int i = 0; i < 4; i++)
+	{
+		if (!(std::fabs(gain[i] - expected) <= tolerance))
+		{
+			std::printf("FAIL %s: cutoff %g: gain %.3f dB, expected %.3f dB\n", name, cutoff[i], gain[i], expected);
+			failures++;
+			return;
+		}
+	}
+	std::printf("ok   %s\n", name);
+}
+
+/** the output must be finite and bounded, with noise and then no input */
+template <typename Filter, typename Output>
+static void testStability(const char* name, Filter filter, float bound, Output output)
+{
+	for (int n = 0; n < 2 * samples; n++)
+	{
+		filter.process(n < samples ? float_4(input(n)) : float_4(0.f));
+		float_4 y = output(filter);
+		for (int i = 0; i < 4; i++)
+		{
+			if (!(std::fabs(y[i]) <= bound))
+			{
+				std::printf("FAIL %s: sample %d, channel %d: %g\n", name, n, i, y[i]);
+				failures++;
+				return;
+			}
+		}
+	}
+	std::printf("ok   %s\n", name);
+}
+
+static void testZDF()
+{
+	const float_4 cutoffs[] = {float_4(0.01f, 0.1f, 0.2f, 0.3f), float_4(0.4f, 0.42f, 0.44f, 0.45f)};
+
+	for (const float_4& cutoff : cutoffs)
+	{
+		// bilinear transform with prewarping: the gain at the cutoff frequency is the one of the analog filter
+		TOnePoleZDF<float_4> onePole;
+		onePole.setCutoffFreq(cutoff);
+		compareGain("TOnePoleZDF<float_4> gain at cutoff", cutoff, measureGain(onePole, cutoff, [](TOnePoleZDF<float_4>& f) { return f.lowpass(); }), -3.0103f);
+
+		TFourPoleZDF<float_4> fourPole;
+		fourPole.setCutoffFreq(cutoff);
+		compareGain("TFourPoleZDF<float_4> gain at cutoff", cutoff, measureGain(fourPole, cutoff, [](TFourPoleZDF<float_4>& f) { return f.lowpass4(); }), -12.0412f);
+
+		// the input is scaled by the damping, the lowpass gain at the cutoff frequency is 1 for all resonances
+		TSVFZDF<float_4> svf;
+		svf.setCutoffFreq(cutoff);
+		svf.setResonance(0.5f);
+		compareGain("TSVFZDF<float_4> gain at cutoff", cutoff, measureGain(svf, cutoff, [](TSVFZDF<float_4>& f) { return f.lowpass(); }), 0.f);
+	}
+
+	// full resonance, up to and beyond the highest cutoff frequency
+	const float_4 cutoff(0.001f, 0.1f, 0.45f, 0.6f);
+
+	TOnePoleZDF<float_4> onePole;
+	onePole.setCutoffFreq(cutoff);
+	testStability("TOnePoleZDF<float_4> stability", onePole, 10.f, [](TOnePoleZDF<float_4>& f) { return f.highpass(); });
+
+	// self oscillation, the output is clamped to 5 V
+	TFourPoleZDF<float_4> fourPole;
+	fourPole.setCutoffFreq(cutoff);
+	fourPole.setResonance(4.f);
+	testStability("TFourPoleZDF<float_4> stability", fourPole, 5.f, [](TFourPoleZDF<float_4>& f) { return f.lowpass4(); });
+
+	TSVFZDF<float_4> svf;
+	svf.setCutoffFreq(cutoff);
+	svf.setResonance(0.999f);
+	testStability("TSVFZDF<float_4> stability", svf, 10.f, [](TSVFZDF<float_4>& f) { return f.bandpass(); });
+}
+
+int main()
+{
+	testOnePole<float>("float", 0.01f);
+	testOnePole<float_4>("float_4", float_4(0.0001f, 0.01f, 0.1f, 0.3f));
+	testFourPole();
+	testSVF();
+	testZDF();
+
+	if (failures)
+	{
+		std::printf("%d failures\n", failures);
+		return 1;
+	}
+	return 0;
+}
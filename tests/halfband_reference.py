@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+"""
+Reference stop band attenuation of the equiripple half band filters of src/dsp/decimator.hpp, for halfband_test.cpp.
+
+Independent of designHalfBand: Parks-McClellan with barycentric interpolation, in double precision.
+With y = cos(2w), H(w) = 1/2 + cos(w) P(y), P of degree order - 1, so the stop band error is a weighted
+polynomial approximation of D = -1/(2 cos(w)) with weight W = |cos(w)|.
+Prints the (order, transition band, attenuation in dB) table of halfband_test.cpp.
+"""
+import math
+
+TIERS = [
+    # order, transition band
+    (1, 127 / 256), (1, 15 / 32), (2, 3 / 8), (4, 1 / 4), (10, 1 / 10),   # eco
+    (2, 15 / 32), (3, 3 / 8), (6, 1 / 4), (22, 1 / 16),                   # standard
+    (2, 127 / 256), (3, 15 / 32), (4, 3 / 8), (8, 1 / 4), (32, 1 / 16),   # mastering
+]
+
+
+def design(order, transition):
+    stop = 2 * math.pi * (0.25 + 0.5 * transition)
+    grid_size = 64 * order + 1
+    w = [stop + (math.pi - stop) * i / (grid_size - 1) for i in range(grid_size)]
+    y = [math.cos(2 * x) for x in w]
+    weight = [abs(math.cos(x)) for x in w]
+    desired = [-0.5 / math.cos(x) for x in w]
+
+    n = order + 1
+    reference = [round(i * (grid_size - 1) / order) for i in range(n)]
+    error = [0.] * grid_size
+    delta = 0.
+    for _ in range(100):
+        ys = [y[k] for k in reference]
+        b = [1. / math.prod(ys[i] - ys[j] for j in range(n) if j != i) for i in range(n)]
+        num = sum(b[i] * desired[k] for i, k in enumerate(reference))
+        den = sum(b[i] * (-1) ** i / weight[k] for i, k in enumerate(reference))
+        delta = num / den
+        # P interpolates D - (-1)^i delta / W on the first n - 1 reference points
+        values = [desired[k] - (-1) ** i * delta / weight[k] for i, k in enumerate(reference)]
+        c = [b[i] * (ys[i] - ys[n - 1]) for i in range(n - 1)]
+
+        for g in range(grid_size):
+            d = [y[g] - ys[i] for i in range(n - 1)]
+            exact = next((i for i in range(n - 1) if d[i] == 0.), None)
+            if exact is not None:
+                p = values[exact]
+            else:
+                p = sum(c[i] / d[i] * values[i] for i in range(n - 1)) / sum(c[i] / d[i] for i in range(n - 1))
+            error[g] = weight[g] * (p - desired[g])
+
+        max_error = max(abs(e) for e in error)
+        if max_error - abs(delta) <= 1e-9 * max_error:
+            break
+
+        extrema = []
+        for g in range(grid_size):
+            if extrema and (error[extrema[-1]] > 0) == (error[g] > 0):
+                if abs(error[g]) > abs(error[extrema[-1]]):
+                    extrema[-1] = g
+            else:
+                extrema.append(g)
+        while len(extrema) > n:
+            if abs(error[extrema[0]]) < abs(error[extrema[-1]]):
+                extrema.pop(0)
+            else:
+                extrema.pop()
+        if len(extrema) < n:
+            break
+        reference = extrema
+
+    return max(abs(e) for e in error)
+
+
+if __name__ == "__main__":
+    for order, transition in TIERS:
+        print("\t{%d, %.8f, %.2f}," % (order, transition, 20 * math.log10(design(order, transition))))
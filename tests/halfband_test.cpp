@@ -0,0 +1,170 @@
+#include <rack.hpp>
+#include "dsp/decimator.hpp"
+#include <cstdio>
+
+/**
+ * Test of designHalfBand: the stop band attenuation of all quality tiers must match the reference of
+ * halfband_reference.py, an independent Parks-McClellan design in Python.
+ * The float coefficients are measured on a dense grid, the rounding to float may add up to sum 2 |c_k| 2^-24 to |H(f)|.
+ * The Standard tier must reproduce the coefficient tables of scripts/filterCoeffs.py (scipy.signal.remez), which it replaced.
+ */
+
+using namespace musx;
+
+struct Reference {
+	int order;
+	double transitionBand;
+	double attenuation; // dB
+};
+
+/** output of halfband_reference.py */
+static const Reference references[] = {
+	{1, 0.49609375, -94.51},
+	{1, 0.46875000, -58.37},
+	{2, 0.37500000, -64.62},
+	{4, 0.25000000, -72.42},
+	{10, 0.10000000, -69.37},
+	{2, 0.46875000, -113.21},
+	{3, 0.37500000, -94.26},
+	{6, 0.25000000, -104.70},
+	{22, 0.06250000, -91.57},
+	{2, 0.49609375, -185.49},
+	{3, 0.46875000, -167.15},
+	{4, 0.37500000, -123.47},
+	{8, 0.25000000, -136.52},
+	{32, 0.06250000, -127.45},
+};
+
+/** coefficient tables of scripts/filterCoeffs.py, used before the design in code */
+static const double filterCoeffs256[1] = {0.2500094126245982};
+static const double filterCoeffs32[2] = {-0.03147685303471284, 0.2814757608962846};
+static const double filterCoeffs8[3] = {0.0071174511083665504, -0.05231169587073679, 0.2952039278517196};
+static const double filterCoeffs4[6] = {-0.00034696754642661164, 0.0025132384125000433, -0.010158904818112154, 0.030552323579531526, -0.08198144832535462, 0.3094188471351897};
+static const double filterCoeffs2[22] = {-3.78984774783134e-05, 7.863590263960349e-05, -0.00015644609673577748, 0.000280705554967871, -0.00046880653545378965, 0.0007418705114406702, -0.0011250733106933466, 0.0016480557249014232, -0.0023455500288496497, 0.003258444430478961, -0.004435660674522054, 0.005937492977997016, -0.007841575438896764, 0.010253701642225216, -0.013328034730955753, 0.01730676011216719, -0.0226037708095706, 0.030000600584212778, -0.04117865039985172, 0.06052862461039207, -0.10419628766252699, 0.3176696599347577};
+
+static const double designTolerance = 0.1; // dB
+static const double tableTolerance = 1e-7; // float rounding of the coefficients is below 2e-8
+static const double coeffsTolerance = 0.5; // dB
+
+static int failures = 0;
+
+/** max |H(f)| in dB on [fStop, 1/2], f is the ratio between frequency and sample rate */
+static double measureStopBand(const float* coeffs, int order, double fStop)
+{
+	const int points = 100000;
+	double maxError = 0.;
+	for (int i = 0; i <= points; i++)
+	{
+		double f = fStop + (0.5 - fStop) * i / points;
+		// the coefficients are ordered from the outermost tap, see HalfBandDecimator
+		double h = 0.5;
+		for (int k = 0; k < order; k++)
+		{
+			h += 2. * coeffs[k] * std::cos(2. * M_PI * f * (2 * order - 1 - 2 * k));
+		}
+		maxError = std::max(maxError, std::fabs(h));
+	}
+	return 20. * std::log10(maxError);
+}
+
+template <typename Coeffs>
+static void testCoeffs(const char* name)
+{
+	const Reference* reference = nullptr;
+	for (const Reference& r : references)
+	{
+		if (r.order == Coeffs::order && std::fabs(r.transitionBand - Coeffs::transitionBand()) < 1e-8)
+		{
+			reference = &r;
+		}
+	}
+	if (!reference)
+	{
+		std::printf("FAIL %s: no reference\n", name);
+		failures++;
+		return;
+	}
+
+	double design = 20. * std::log10(Coeffs::instance().stopBandError);
+	double measured = measureStopBand(Coeffs::get(), Coeffs::order, 0.25 + 0.5 * Coeffs::transitionBand());
+	bool designOk = std::fabs(design - reference->attenuation) <= designTolerance;
+	double roundingError = 0.;
+	for (int k = 0; k < Coeffs::order; k++)
+	{
+		roundingError += 2. * std::fabs(Coeffs::get()[k]) * std::ldexp(1., -24);
+	}
+	double limit = 20. * std::log10(std::pow(10., reference->attenuation / 20.) + roundingError) + designTolerance;
+	bool measuredOk = measured <= limit;
+
+	std::printf("%s %-36s reference %7.2f dB, design %7.2f dB, float coefficients %7.2f dB\n",
+			designOk && measuredOk ? "ok  " : "FAIL", name, reference->attenuation, design, measured);
+	if (!designOk || !measuredOk)
+	{
+		failures++;
+	}
+}
+
+/** the wider transition band of getForPassBand must not be worse than the default design */
+template <typename Coeffs>
+static void testPassBand(const char* name, double passBand)
+{
+	float coeffs[Coeffs::order];
+	Coeffs::getForPassBand(passBand, coeffs);
+	double measured = measureStopBand(coeffs, Coeffs::order, 0.5 - 0.5 * passBand);
+	double design = 20. * std::log10(Coeffs::instance().stopBandError);
+	bool ok = measured <= design + coeffsTolerance;
+
+	std::printf("%s %-36s pass band %.3f: %7.2f dB, default %7.2f dB\n", ok ? "ok  " : "FAIL", name, passBand, measured, design);
+	if (!ok)
+	{
+		failures++;
+	}
+}
+
+/** the designed coefficients must match the table of scripts/filterCoeffs.py */
+template <typename Coeffs, int N>
+static void testTable(const char* name, const double (&table)[N])
+{
+	static_assert(N == Coeffs::order, "table and design must have the same order");
+	double maxDiff = 0.;
+	for (int k = 0; k < N; k++)
+	{
+		maxDiff = std::max(maxDiff, std::fabs(Coeffs::get()[k] - table[k]));
+	}
+	bool ok = maxDiff <= tableTolerance;
+
+	std::printf("%s %-36s scripts/filterCoeffs.py table, max difference %g\n", ok ? "ok  " : "FAIL", name, maxDiff);
+	if (!ok)
+	{
+		failures++;
+	}
+}
+
+#define TEST_TIER(Q) \
+	testCoeffs<Q::Coeffs256>(#Q "::Coeffs256"); \
+	testCoeffs<Q::Coeffs32>(#Q "::Coeffs32"); \
+	testCoeffs<Q::Coeffs8>(#Q "::Coeffs8"); \
+	testCoeffs<Q::Coeffs4>(#Q "::Coeffs4"); \
+	testCoeffs<Q::Coeffs2>(#Q "::Coeffs2"); \
+	testPassBand<Q::Coeffs2>(#Q "::Coeffs2", 20000. / 96000.); \
+	testPassBand<Q::Coeffs2>(#Q "::Coeffs2", 20000. / 192000.);
+
+int main()
+{
+	TEST_TIER(HalfBandQualityEco)
+	TEST_TIER(HalfBandQualityStandard)
+	TEST_TIER(HalfBandQualityMastering)
+
+	testTable<HalfBandQualityStandard::Coeffs256>("HalfBandQualityStandard::Coeffs256", filterCoeffs256);
+	testTable<HalfBandQualityStandard::Coeffs32>("HalfBandQualityStandard::Coeffs32", filterCoeffs32);
+	testTable<HalfBandQualityStandard::Coeffs8>("HalfBandQualityStandard::Coeffs8", filterCoeffs8);
+	testTable<HalfBandQualityStandard::Coeffs4>("HalfBandQualityStandard::Coeffs4", filterCoeffs4);
+	testTable<HalfBandQualityStandard::Coeffs2>("HalfBandQualityStandard::Coeffs2", filterCoeffs2);
+
+	if (failures)
+	{
+		std::printf("%d failures\n", failures);
+		return 1;
+	}
+	return 0;
+}
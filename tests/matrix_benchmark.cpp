@@ -0,0 +1,135 @@
+#include "dsp/matrix.hpp"
+#include <chrono>
+#include <cstdio>
+
+/**
+ * Benchmark of the ModMatrix kernels: time per sample of a 12x16 matrix for 1, 4 and 16 channels,
+ * with 10%, 50% and 100% of the cells set.
+ * The sparse and dense kernels of CoefficientMatrix are compared with a loop over all cells, which is what
+ * ModMatrix did before.
+ */
+
+using namespace musx;
+
+static const int rows = 12;
+static const int columns = 16;
+static const int samples = 1 << 18;
+
+typedef CoefficientMatrix<rows, columns> Matrix;
+
+/** all cells, like the original ModMatrix */
+static void processAllCells(const Matrix& matrix, const float_4* in, float_4* out)
+{
+	for (int j = 0; j < columns; j++)
+	{
+		for (int i = 0; i < rows; i++)
+		{
+			out[j] += in[i] * matrix.coeffs[i][j];
+		}
+	}
+}
+
+enum Kernel {
+	ALL_CELLS,
+	SPARSE,
+	DENSE
+};
+
+/** ns per sample, all groups of 4 channels */
+template <Kernel KERNEL>
+static double run(Matrix& matrix, int channels, float& checksum)
+{
+	float_4 in[4][rows];
+	for (int g = 0; g < 4; g++)
+	{
+		for (int i = 0; i < rows; i++)
+		{
+			in[g][i] = float_4(0.1f * i, -0.2f * g, 0.3f, -0.4f);
+		}
+	}
+
+	float_4 sum = 0.f;
+	auto start = std::chrono::steady_clock::now();
+	for (int n = 0; n < samples; n++)
+	{
+		// the inputs change on every sample, so all columns are recalculated
+		matrix.setAllDirty();
+		for (int c = 0; c < channels; c += 4)
+		{
+			in[c/4][n % rows] += 0.001f;
+
+			float_4 out[columns];
+			for (int j = 0; j < columns; j++)
+			{
+				out[j] = 0.f;
+			}
+
+			switch (KERNEL)
+			{
+				case ALL_CELLS:
+					processAllCells(matrix, in[c/4], out);
+					break;
+				case SPARSE:
+					matrix.processSparse(in[c/4], out);
+					break;
+				case DENSE:
+					matrix.processDense(in[c/4], out);
+					break;
+			}
+
+			for (int j = 0; j < columns; j++)
+			{
+				sum += out[j];
+			}
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	checksum += sum[0] + sum[1] + sum[2] + sum[3];
+	return std::chrono::duration<double, std::nano>(end - start).count() / samples;
+}
+
+int main()
+{
+	float checksum = 0.f;
+	const float densities[] = {0.1f, 0.5f, 1.f};
+	const int channelCounts[] = {1, 4, 16};
+
+	std::printf("%-10s %-10s %12s %12s %12s\n", "cells [%]", "channels", "all cells", "sparse", "dense");
+
+	for (float density : densities)
+	{
+		Matrix matrix;
+		uint32_t random = 1;
+		for (int i = 0; i < rows; i++)
+		{
+			matrix.setRowActive(i, true);
+			for (int j = 0; j < columns; j++)
+			{
+				random = random * 1664525 + 1013904223;
+				if ((random >> 8) % 1000 < density * 1000)
+				{
+					matrix.setCoeff(i, j, (random >> 16) / 65536.f - 0.5f);
+				}
+			}
+		}
+		for (int j = 0; j < columns; j++)
+		{
+			matrix.setColumnActive(j, true);
+		}
+		matrix.compile();
+
+		for (int channels : channelCounts)
+		{
+			double allCells = run<ALL_CELLS>(matrix, channels, checksum);
+			double sparse = run<SPARSE>(matrix, channels, checksum);
+			double dense = run<DENSE>(matrix, channels, checksum);
+			std::printf("%-10.0f %-10d %9.1f ns %9.1f ns %9.1f ns%s\n", 100.f * density, channels, allCells, sparse, dense,
+					matrix.useDense ? "  (dense chosen)" : "  (sparse chosen)");
+		}
+	}
+
+	// keeps the compiler from removing the loops
+	std::printf("checksum %g\n", checksum);
+	return 0;
+}
@@ -0,0 +1,144 @@
+#include "dsp/oscillators.hpp"
+#include <chrono>
+#include <cstdio>
+
+/**
+ * Benchmark of the Oscillators inner loop of src/dsp/oscillators.hpp: time per oversampled sample of processOscillators
+ * specialized for sync, FM and ring modulator off, with all three enabled but zero amounts, and of the generic loop
+ * before the specialization, which had no polyBLEP.
+ * With oscillator 2 muted, the outputs only differ by the one sample delay of the polyBLEP, the maximum difference
+ * is printed as a check.
+ */
+
+using namespace musx;
+
+static const int blockLength = 16; // 16x oversampling
+static const int blocks = 1 << 16;
+
+struct State {
+	int32_4 phasor1Sub = 0;
+	int32_4 phasor2 = 0;
+	float_4 mixDelay = 0.f;
+};
+
+/** the generic loop before the specialization, with the sync, FM and ring modulator terms always calculated */
+static void processGeneric(const OscillatorParameters& p, int32_4& phasor1Sub, int32_4& phasor2, float_4&,
+		int32_4 phase1SubInc, int32_4 phase2Inc, float_4 fmAmt, float_4* out, int n)
+{
+	int32_4 phase1Inc = phase1SubInc + phase1SubInc;
+	float_4 tri1Amt = 2.f * simd::fmax(-p.osc1Shape, 0.f);  // [2, 0, 0]
+	float_4 sawSq1Amt = simd::fmin(1.f + p.osc1Shape, 1.f); // [0, 1, 1]
+	float_4 sq1Amt = simd::fmax(p.osc1Shape, 0.f);          // [0, 0, 1]
+	int32_4 phase1Offset = simd::ifelse(p.osc1PW < 0, (-1.f - p.osc1PW) * INT32_MAX, (1.f - p.osc1PW) * INT32_MAX); // for pulse wave = saw + inverted saw with phaseshift
+
+	float_4 tri2Amt = 2.f * simd::fmax(-p.osc2Shape, 0.f);
+	float_4 sawSq2Amt = simd::fmin(1.f + p.osc2Shape, 1.f);
+	float_4 sq2Amt = simd::fmax(p.osc2Shape, 0.f);
+	int32_4 phase2Offset = simd::ifelse(p.osc2PW < 0, (-1.f - p.osc2PW) * INT32_MAX, (1.f - p.osc2PW) * INT32_MAX); // for pulse wave
+
+	for (int i = 0; i < n; ++i)
+	{
+		// phasors for subosc 1 and osc 1
+		phasor1Sub += phase1SubInc;
+		int32_4 phasor1 = phasor1Sub + phasor1Sub;
+		int32_4 phasor1Offset = phasor1 + phase1Offset;
+
+		// osc 1 waveform
+		float_4 wave1 = tri1Amt * ((1.f*phasor1Offset + (phasor1Offset > 0) * 2.f * phasor1Offset) + INT32_MAX/2); // +-INT32_MAX
+		wave1 += sawSq1Amt * (phasor1Offset * sq1Amt - 1.f * phasor1); // +-INT32_MAX
+
+		// osc 1 suboscillator
+		float_4 sub1 = 1.f * (phasor1Sub + INT32_MAX) - 1.f * phasor1Sub; // +-INT32_MAX
+
+		// phasor for osc 2
+		phasor2 += phase2Inc + int32_4(fmAmt * wave1);
+
+		// sync / reset phasor2 ?
+		phasor2 -= (p.sync & (phasor1 + phase1Inc < phasor1)) * (phasor2 + INT32_MAX);
+		int32_4 phasor2Offset = phasor2 + phase2Offset;
+
+		// osc 2 waveform
+		float_4 wave2 = tri2Amt * ((1.f*phasor2Offset + (phasor2Offset > 0) * 2.f * phasor2Offset) + INT32_MAX/2); // +-INT32_MAX
+		wave2 += sawSq2Amt * (phasor2Offset * sq2Amt - 1.f * phasor2); // +-INT32_MAX
+
+		// mix
+		out[i] = p.osc1Subvol * sub1 + p.osc1Vol * wave1 + p.osc2Vol * wave2 + p.ringmod * wave1 * wave2; // +-5V each
+	}
+}
+
+typedef void (*Loop)(const OscillatorParameters&, int32_4&, int32_4&, float_4&, int32_4, int32_4, float_4, float_4*, int);
+
+/** ns per oversampled sample, all groups of 4 channels. The first sample of each block of the first group is written to out */
+static double run(Loop loop, const OscillatorParameters& p, int channels, float_4* out)
+{
+	State state[4];
+	int32_4 phase1SubInc = int32_4(float_4(1e6f, 2e6f, 3e6f, 4e6f));
+	int32_4 phase2Inc = int32_4(float_4(5e6f, 6e6f, 7e6f, 8e6f));
+	float_4 fmAmt = 0.f;
+	float_4 buffer[blockLength];
+
+	auto start = std::chrono::steady_clock::now();
+	for (int b = 0; b < blocks; b++)
+	{
+		for (int c = 0; c < channels; c += 4)
+		{
+			State& s = state[c/4];
+			loop(p, s.phasor1Sub, s.phasor2, s.mixDelay, phase1SubInc, phase2Inc, fmAmt, buffer, blockLength);
+			if (c == 0)
+			{
+				for (int i = 0; i < blockLength; i++)
+				{
+					out[b * blockLength + i] = buffer[i];
+				}
+			}
+		}
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::nano>(end - start).count() / ((double)blocks * blockLength);
+}
+
+int main()
+{
+	OscillatorParameters p;
+	p.osc1Shape = -0.3f;
+	p.osc1PW = 0.2f;
+	p.osc1Vol = 0.5f / INT32_MAX;
+	p.osc1Subvol = 0.2f / INT32_MAX;
+	p.osc2Shape = 0.6f;
+	p.osc2PW = -0.1f;
+	p.osc2Vol = 0.5f / INT32_MAX;
+	// sync, FM and ring modulator amounts are 0
+
+	float_4* specializedOut = new float_4[blocks * blockLength];
+	float_4* genericOut = new float_4[blocks * blockLength];
+	const int channelCounts[] = {4, 16};
+
+	std::printf("%-10s %14s %14s %14s\n", "channels", "specialized", "all enabled", "generic");
+
+	for (int channels : channelCounts)
+	{
+		double specialized = run(&processOscillators<false, false, false>, p, channels, specializedOut);
+		double enabled = run(&processOscillators<true, true, true>, p, channels, specializedOut);
+		double generic = run(&processGeneric, p, channels, genericOut);
+
+		std::printf("%-10d %11.2f ns %11.2f ns %11.2f ns\n", channels, specialized, enabled, generic);
+	}
+
+	// same output without oscillator 2, which has the polyBLEP
+	p.osc2Vol = 0.f;
+	run(&processOscillators<false, false, false>, p, 4, specializedOut);
+	run(&processGeneric, p, 4, genericOut);
+
+	float maxDiff = 0.f;
+	for (int n = 1; n < blocks * blockLength; n++)
+	{
+		float_4 diff = simd::fabs(specializedOut[n] - genericOut[n - 1]);
+		maxDiff = std::max(maxDiff, std::max(std::max(diff[0], diff[1]), std::max(diff[2], diff[3])));
+	}
+	std::printf("max difference without oscillator 2: %g\n", maxDiff);
+
+	delete[] genericOut;
+	delete[] specializedOut;
+	return 0;
+}